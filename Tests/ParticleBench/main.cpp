@@ -0,0 +1,184 @@
+#include <Engine.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace SuperEngine;
+
+// Runs CircleEmitter and TextureEmitter headless at a few sizes and prints
+// one CSV row each to stdout, so runs can be diffed or fed to a script:
+//
+//   emitter,particles,frames,update_ns,spawn_ns,build_ns,allocs_per_frame,spawn_allocs
+//
+// update_ns, spawn_ns and build_ns are nanoseconds per particle for one
+// Update(), spawning the whole max in one burst and writing the batch
+// vertices. allocs_per_frame counts operator new calls over an update plus a
+// batch build once the emitter is full, plus particle blocks taken with
+// calloc or from an arena, it should stay at 0.
+
+// Every operator new in the program goes through here
+static std::atomic<std::size_t> s_allocs(0);
+
+// Particle storage doesn't go through operator new, count that too
+static std::size_t Allocations()
+{
+    return s_allocs + ParticleData::getBlocksAllocated();
+}
+
+void* operator new(std::size_t size)
+{
+    s_allocs++;
+
+    if(void* p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+static const std::size_t SIZES[] = { 1000, 10000, 100000, 1000000 };
+
+// Roughly the same amount of particle work at every size
+static const std::size_t PARTICLE_FRAMES = 4000000;
+static const std::size_t MIN_FRAMES = 5;
+
+static const float STEP = 1.f / 60.f;
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double nsSince(BenchClock::time_point start)
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - start).count();
+}
+
+// Spawning on its own is only reachable from inside an emitter
+template<typename T>
+class BenchEmitter: public T
+{
+public:
+    explicit BenchEmitter(Engine& engine) : T(engine) {}
+
+    bool Spawn(float elapsedTime) { return this->SpawnParticles(elapsedTime); }
+};
+
+// Fewest segments there are, 18 vertices a particle would need 360MB of
+// batch at 1M. The cost per vertex is what matters here.
+static void Setup(CircleEmitter& e) { e.setParticleSegments(3); }
+// Textures need a GL context, headless the emitter draws with an empty one.
+// Same triangles either way.
+static void Setup(TextureEmitter& e) {}
+
+template<typename T>
+void Bench(const char* name, std::size_t particles)
+{
+    BenchEmitter<T> e(*g_pEngine);
+    Setup(e);
+
+    // Middle of the screen so culling never gets in the way
+    e.setPosition(g_pEngine->getScreenWidth() / 2.f, g_pEngine->getScreenHeight() / 2.f);
+    e.setMax(particles);
+    e.setSpread(360);
+    e.setVelocity(50.f, 50.f);
+    e.setLength(200);
+    e.setEmissionRate(0);
+    e.addBurst(0.f, particles);
+
+    std::size_t frames = std::max(MIN_FRAMES, PARTICLE_FRAMES / particles);
+
+    // Spawn, the first pass also reserves so it is timed separately
+    e.Spawn(STEP);
+
+    double spawn = 0.0;
+    std::size_t spawnAllocs = 0;
+
+    for(std::size_t i = 0; i < frames; i++)
+    {
+        e.clearParticles();
+        e.getEmission().reset();
+
+        std::size_t allocs = Allocations();
+        BenchClock::time_point start = BenchClock::now();
+
+        e.Spawn(STEP);
+
+        spawn += nsSince(start);
+        spawnAllocs += Allocations() - allocs;
+    }
+
+    // Sized up front, a ParticleSystem keeps its batch arrays between frames
+    std::vector<sf::Vertex> vertices(e.getVertexCount());
+
+    e.getEmission().clearBursts();
+
+    double update = 0.0, build = 0.0;
+    std::size_t frameAllocs = 0;
+
+    for(std::size_t i = 0; i < frames; i++)
+    {
+        std::size_t allocs = Allocations();
+        BenchClock::time_point start = BenchClock::now();
+
+        e.Update(STEP);
+
+        update += nsSince(start);
+        start = BenchClock::now();
+
+        e.writeVertices(&vertices[0], 0.f);
+
+        build += nsSince(start);
+        frameAllocs += Allocations() - allocs;
+    }
+
+    double perParticle = (double)frames * (double)particles;
+
+    std::printf("%s,%u,%u,%.3f,%.3f,%.3f,%.2f,%.2f\n", name, (unsigned int)particles, (unsigned int)frames,
+                update / perParticle, spawn / perParticle, build / perParticle,
+                (double)frameAllocs / frames, (double)spawnAllocs / frames);
+    std::fflush(stdout);
+}
+
+bool game_preload()
+{
+    g_pEngine->setAppTitle("PARTICLE BENCH");
+    g_pEngine->setScreenWidth(1024);
+    g_pEngine->setScreenHeight(768);
+    g_pEngine->setColorDepth(32);
+
+    // No window, no pacing, just the emitters
+    g_pEngine->setHeadless(true);
+
+    return true;
+}
+
+bool game_init()
+{
+    return true;
+}
+
+void game_update(float elapsedTime)
+{
+    std::printf("emitter,particles,frames,update_ns,spawn_ns,build_ns,allocs_per_frame,spawn_allocs\n");
+
+    for(std::size_t size : SIZES)
+    {
+        Bench<CircleEmitter>("CircleEmitter", size);
+        Bench<TextureEmitter>("TextureEmitter", size);
+    }
+
+    g_pEngine->Shutdown();
+}
+
+void game_render()
+{
+}
+
+void game_end()
+{
+}
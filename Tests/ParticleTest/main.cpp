@@ -2,6 +2,9 @@
 
 using namespace SuperEngine;
 
+// Owns and batches all of the emitters
+ParticleSystem* ps;
+
 TextureEmitter* pa;
 CircleEmitter* pb;
 CircleEmitter* pc;
@@ -21,7 +24,9 @@ bool game_init()
 {
     g_pEngine->setMaximizeProcessor(true);
 
-    pa = new TextureEmitter();
+    ps = new ParticleSystem(*g_pEngine);
+
+    pa = ps->create<TextureEmitter>();
     pa->loadImage("particle16.tga");
     pa->setPosition(100, 300);
     pa->setDirection(0);
@@ -33,7 +38,7 @@ bool game_init()
     pa->setVelocity(50.f, 50.f);
     pa->setLength(250);
 
-    pb = new CircleEmitter();
+    pb = ps->create<CircleEmitter>();
     //pb->loadImage("particle16.tga");
     pb->setPosition(300, 100);
     pb->setDirection(180);
@@ -45,7 +50,7 @@ bool game_init()
     pb->setVelocity(50.f, 50.0f);
     pb->setLength(200);
 
-    pc = new CircleEmitter();
+    pc = ps->create<CircleEmitter>();
     //pc->loadImage("particle16.tga");
     pc->setPosition(250, 525);
     pc->setDirection(0);
@@ -62,25 +67,20 @@ bool game_init()
 
 void game_update(float elapsedTime)
 {
-    pa->Update(elapsedTime);
-    pb->Update(elapsedTime);
-
     // update circular controller
     float dir = pc->getDirection() + 0.2f;
     pc->setDirection(dir);
-    pc->Update(elapsedTime);
+
+    ps->Update(elapsedTime);
 }
 
 void game_end()
 {
-    delete pa;
-    delete pb;
-    delete pc;
+    // Deletes the emitters too
+    delete ps;
 }
 
 void game_render()
 {
-    pa->Draw();
-    pb->Draw();
-    pc->Draw();
+    ps->Draw();
 }
@@ -19,7 +19,7 @@ Sprite* sprite2;
 
 bool game_init()
 {
-    sprite = new Sprite();
+    sprite = new Sprite(*g_pEngine);
 
     sprite->setFrameTimer(true);
 //    sprite->setMoveTimer(false);
@@ -29,7 +29,7 @@ bool game_init()
     sprite->loadImage("asteroid_sheet.png", 21, 7);
     sprite->setTotalFrames(143);
 
-    sprite2 = new Sprite();
+    sprite2 = new Sprite(*g_pEngine);
     sprite2->setFrameTimer(true);
 //    sprite->setMoveTimer(false);
     sprite2->setFrameDelay(16);
@@ -39,7 +39,7 @@ bool game_init()
     sprite2->setTotalFrames(143);
 
 
-    explosion = new Sprite();
+    explosion = new Sprite(*g_pEngine);
 
     explosion->setFrameTimer(true);
     explosion->setFrameDelay(16);
@@ -28,6 +28,7 @@ it freely, subject to the following restrictions:
 
 // 8-Aug-2013 - Modified for convenience
 #include "MapLoader.h"
+#include <Utils/Profiler.h>
 
 using namespace tmx;
 
@@ -59,6 +60,8 @@ MapLoader::~MapLoader()
 
 const bool MapLoader::Load(std::string map)
 {
+	PROFILE_SCOPE("MapLoader::Load");
+
 	map = m_mapDirectory + map;
 	m_Unload(); //clear any old data first
 
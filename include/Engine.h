@@ -9,9 +9,20 @@
 #include <iostream>
 // Shared and weak pointers
 #include <memory>
+// Game callbacks
+#include <functional>
+// Render thread
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // Engine parts
 #include <Utils/Logger.h>
+#include <Utils/FramePacer.h>
+#include <Utils/Profiler.h>
+#include <Utils/FrameStats.h>
+#include <Utils/Replay.h>
+#include <Utils/Random.h>
 
 // Resources
 #include <Resources/XMLoader.h>
@@ -19,20 +30,33 @@
 #include <Resources/TextureLoader.h>
 
 #include <Memory/MemoryPool.h>
+#include <Memory/ParticleArena.h>
+
+#include <Threading/JobSystem.h>
 
 #include <Utils/Vector2.h>
 
+#include <Graphics/BlendMode.h>
+#include <Graphics/RenderQueue.h>
 #include <Graphics/Drawable.h>
 #include <Graphics/Sprite.h>
+#include <Graphics/SpriteBatch.h>
+#include <Graphics/ParticleData.h>
+#include <Graphics/EmissionController.h>
+#include <Graphics/ParticleAffector.h>
 #include <Graphics/IParticleEmitter.h>
+#include <Graphics/EmitterPolicies.h>
 #include <Graphics/CircleEmitter.h>
 #include <Graphics/TextureEmitter.h>
+#include <Graphics/ParticleLOD.h>
+#include <Graphics/ParticleSystem.h>
 
 #define VERSION_MAJOR 0
 #define VERSION_MINOR 2
 #define REVISION 1
 
-#define KEY_DOWN(vk) (sf::Keyboard::isKeyPressed(vk) ? 1 : 0)
+// Goes through the engine so key presses can be recorded and replayed
+#define KEY_DOWN(vk) (g_pEngine->isKeyDown(vk) ? 1 : 0)
 
 extern bool gameover;
 
@@ -44,6 +68,16 @@ extern void game_end();
 
 namespace SuperEngine
 {
+    // What an engine calls in to, defaults to the global game_ functions.
+    // Give each engine its own set to run several worlds in one process.
+    struct GameCallbacks
+    {
+        std::function<bool()> init;
+        std::function<void(float)> update;
+        std::function<void()> render;
+        std::function<void()> end;
+    };
+
     // Just to make things look better :P
     // i decided that there's no point making a camera system,
     // SFML has that covered... damn you SFML!!
@@ -61,32 +95,95 @@ namespace SuperEngine
 
         float m_timePerFrame;
 
+        // Fixed timestep state, m_accumulator holds time not simulated yet
+        sf::Clock m_updateClock;
+        float m_accumulator;
+        // Most game_update calls one Update() may make before giving up on
+        // catching up, stops a slow frame from making the next one slower
+        unsigned int m_maxUpdatesPerFrame;
+        // How far between the last update and the next one we are rendering
+        float m_interpolation;
+        unsigned long m_tickCount;
+        unsigned long m_droppedUpdates;
+
         unsigned int m_ScreenWidth, m_ScreenHeight, m_ColorDepth;
         bool m_Fullscreen;
         const char* m_AppTitle;
 
         bool m_pausemode;
+        // Set by Shutdown(), also sets the global gameover for the global engine
+        bool m_shutdown;
+
+        GameCallbacks m_game;
         sf::Color m_ambientColor;
         // Can be changed so that the screen clears to a different color
         sf::Color m_clearColor;
         // Set processing to full speed with no milisecond delay
         bool m_maximizeProcessor;
-
-        // Timers
-//        sf::Clock m_coreTimer;
-//        long m_frameCount_core;
-//        long m_frameRate_core;
-//        sf::Clock m_realTimer;
-//        long m_frameCount_real;
-//        long m_frameRate_real;
+        // Sleeps out the rest of each frame unless the processor is maximized
+        FramePacer m_framePacer;
+        // Run without a window, game_update is stepped once per Update()
+        // at full speed and all drawing is dropped
+        bool m_headless;
+        // Draw calls submitted since the scene was last cleared
+        unsigned long m_drawCallCount;
+
+        // Zones from this engine's threads and jobs, current while it runs
+        Profiler m_profiler;
+
+        // Timers, core is simulation ticks and real is rendered frames
+        sf::Clock m_realTimer;
+        FrameStats m_frameStats;
+        // Seconds the last frame was busy for, not counting the pacer's wait
+        float m_frameWorkTime;
+
+        // Last view passed to setView, or the whole window
+        Camera m_camera;
 
         // Used by sprite class for optimization, will only load image once
         // Using textures, because they are sent directly to the GPU,
-        // if i have duplicates, its wasteful
-        TextureLoader m_textureManager;
+        // if i have duplicates, its wasteful. Can be shared between engines.
+        std::shared_ptr<TextureLoader> m_pTextureManager;
+
+        // Seed for every Random stream, stored in recordings. Also seeds
+        // std::srand and the thread streams if this is the first engine running.
+        unsigned int m_seed;
+        // Streams handed out since Init, each one gets a different seed
+        std::uint64_t m_streamCount;
+
+        // Input and timestep recording or playback
+        Replay m_replay;
+        std::string m_recordFile;
+        bool m_keyState[sf::Keyboard::KeyCount];
+
+        // Worker threads for game_update work. Init() picks up the shared
+        // pool, so every engine in the process uses the same workers.
+        std::shared_ptr<JobSystem> m_pJobSystem;
+        unsigned int m_workerCount;
 
         sf::RenderWindow* m_pDevice;
 
+        // Pipelined rendering, frame N is drawn on the render thread while
+        // frame N + 1 is simulated. game_render records into m_pRecordQueue
+        // and the render thread plays back m_pPendingQueue.
+        bool m_threadedRendering;
+        std::thread m_renderThread;
+        std::mutex m_renderMutex;
+        std::condition_variable m_renderCond;
+        RenderQueue m_renderQueues[2];
+        RenderQueue* m_pRecordQueue;
+        RenderQueue* m_pPendingQueue;
+        bool m_renderQuit;
+
+        // Sprites drawn this frame, flushed at the end of the frame or
+        // before anything else is drawn
+        SpriteBatch m_spriteBatch;
+        bool m_spriteBatching;
+
+        void RenderThread();
+        void SubmitFrame();
+        void StopRenderThread();
+
         int Release();
 
         int RenderStart();
@@ -104,21 +201,103 @@ namespace SuperEngine
         void Shutdown();
         void ClearScene();
 
+        // Use instead of the device's pollEvent, works headless and in replays
+        bool pollEvent(sf::Event& event);
+        bool isKeyDown(sf::Keyboard::Key key) const;
+
+        // Must be set before Init()
+        void setSeed(unsigned int seed) { m_seed = seed; }
+        unsigned int getSeed() const { return m_seed; }
+        // Seed for a new Random stream, derived from the engine seed. Streams
+        // made in the same order after Init() get the same seeds every run.
+        std::uint64_t makeStreamSeed() { return Random::mix(m_seed, ++m_streamCount); }
+
+        // Call before Init(). Records the seed, input events and frame times
+        // of this session to a binary log.
+        void recordTo(const std::string& filename) { m_recordFile = filename; }
+        // Call before Init(). Plays a log back instead of reading the window
+        // and the clock, combine with setHeadless(true) to run at full speed.
+        // The engine shuts down when the log ends.
+        bool replayFrom(const std::string& filename);
+        bool isReplaying() const { return m_replay.isPlaying(); }
+        bool isRecording() const { return m_replay.isRecording(); }
+        // Submit a drawable to the device, does nothing when running headless.
+        // With threaded rendering the drawable is copied, so it is safe to
+        // change it straight after this returns.
+        template<typename T>
+        void Draw(const T& drawable, const sf::RenderStates& states = sf::RenderStates::Default)
+        {
+            PROFILE_SCOPE("Engine::Draw");
+
+            // Batched sprites were drawn before this, they go first
+            if(!m_spriteBatch.empty())
+                m_spriteBatch.Flush();
+
+            ++m_drawCallCount;
+
+            if(m_pRecordQueue)
+                m_pRecordQueue->push(drawable, states);
+            else if(m_pDevice)
+                m_pDevice->draw(drawable, states);
+        }
+
+        // Draws without copying the vertices. When threaded the frame takes
+        // them and hands back a buffer from an older frame, so vertices has
+        // to be filled in again before it is drawn again.
+        void DrawVertices(std::vector<sf::Vertex>& vertices, sf::PrimitiveType primitive,
+                          const sf::RenderStates& states = sf::RenderStates::Default);
+
+        // Sprites draw through this when sprite batching is on, which it
+        // is by default. Turn it off to draw every sprite straight away in
+        // the order Draw() is called.
+        SpriteBatch& getSpriteBatch() { return m_spriteBatch; }
+        void setSpriteBatching(bool val) { m_spriteBatching = val; }
+        bool isSpriteBatching() const { return m_spriteBatching; }
+
+        // Use this instead of getDevice()->setView() so it works when threaded
+        void setView(const Camera& camera);
+        const Camera& getView() const { return m_camera; }
+
         bool isPaused() const { return m_pausemode; }
         void setPaused(bool val) { m_pausemode = val; }
 
         sf::RenderWindow* getDevice() { return m_pDevice; }
 
+        // Must be set before Init(), a headless engine never creates a device
+        void setHeadless(bool val) { m_headless = val; }
+        bool isHeadless() const { return m_headless; }
+
+        unsigned long getDrawCallCount() const { return m_drawCallCount; }
+
+        // Must be set before Init(), the device is then owned by the render thread
+        void setThreadedRendering(bool val) { m_threadedRendering = val; }
+        bool isThreadedRendering() const { return m_threadedRendering; }
+
         int getVersionMajor() const { return m_versionMajor; }
         int getVersionMinor() const { return m_versionMinor; }
         int getRevision() const { return m_revision; }
         const std::string getVersionText() const;
 
-//        long getFrameRate_core() { return m_frameRate_core; }
-//        long getFrameRate_real() { return m_frameRate_real; }
+        long getFrameRate_core() const { return (long)(m_frameStats.getSnapshot().tickRate + 0.5f); }
+        long getFrameRate_real() const { return (long)(m_frameStats.getSnapshot().frameRate + 0.5f); }
+        // Percentiles and counters, safe to read from any thread
+        FrameStatsSnapshot getFrameStats() const { return m_frameStats.getSnapshot(); }
+        Profiler& getProfiler() { return m_profiler; }
 
         void setFPS(int FPS) { m_Fps = FPS; m_timePerFrame = 1.f / (float)FPS; }
         int getFPS() const { return m_Fps; }
+        float getTimePerFrame() const { return m_timePerFrame; }
+
+        void setMaxUpdatesPerFrame(unsigned int val) { m_maxUpdatesPerFrame = val; }
+        unsigned int getMaxUpdatesPerFrame() const { return m_maxUpdatesPerFrame; }
+
+        // Blend factor between the previous and the current update, [0, 1).
+        // Read it in game_render to draw things where they are right now.
+        float getInterpolation() const { return m_interpolation; }
+        // Number of game_update calls so far
+        unsigned long getTickCount() const { return m_tickCount; }
+        // Updates skipped because the catch up budget ran out
+        unsigned long getDroppedUpdates() const { return m_droppedUpdates; }
 
         const sf::Color getClearColor() const { return m_clearColor; }
         void setClearColor(const sf::Color& val);
@@ -138,10 +317,43 @@ namespace SuperEngine
         void setMaximizeProcessor(bool val) { m_maximizeProcessor = val; }
         bool getMaximizeProcessor() const { return m_maximizeProcessor; }
 
-        TextureLoader& getTextureManager() { return m_textureManager; }
+        // Rendered frames per second when the processor isn't maximized, 0 for no limit
+        void setFrameLimit(unsigned int fps) { m_framePacer.setTargetFPS(fps); }
+        unsigned int getFrameLimit() const { return m_framePacer.getTargetFPS(); }
+        // Frames that were already late by the time they finished
+        unsigned long getMissedFrames() const { return m_framePacer.getMissedDeadlines(); }
+        // How long the last frame took without the sleep at the end, this is
+        // what to compare against a frame budget
+        float getFrameWorkTime() const { return m_frameWorkTime; }
+
+        TextureLoader& getTextureManager() { return *m_pTextureManager; }
+        std::shared_ptr<TextureLoader> getSharedTextureManager() { return m_pTextureManager; }
+        // Share textures with another engine, load them all first, the
+        // loader isn't safe to modify while other threads read from it
+        void setTextureManager(const std::shared_ptr<TextureLoader>& manager) { m_pTextureManager = manager; }
+
+        // Replace the global game_ functions for this engine
+        void setGameCallbacks(const GameCallbacks& callbacks) { m_game = callbacks; }
+        const GameCallbacks& getGameCallbacks() const { return m_game; }
+
+        bool isShutdown() const { return m_shutdown; }
+
+        // Must be set before Init(), 0 uses one worker per hardware thread
+        // minus the one the engine runs on. Only the engine that starts the
+        // shared pool decides how many workers it gets.
+        void setWorkerCount(unsigned int val) { m_workerCount = val; }
+        unsigned int getWorkerCount() const { return m_workerCount; }
+        JobSystem& getJobSystem() { return *m_pJobSystem; }
+        std::shared_ptr<JobSystem> getSharedJobSystem() { return m_pJobSystem; }
+        // Use these workers instead of the shared pool, set before Init().
+        // A pool that is already running is kept as it is.
+        void setJobSystem(const std::shared_ptr<JobSystem>& jobs) { m_pJobSystem = jobs; }
     };
 };
 
 extern SuperEngine::Engine* g_pEngine;
 
+// Templates that need the whole engine, not just a forward declaration
+#include <Graphics/Emitter.h>
+
 #endif // _ENGINE_H_
@@ -0,0 +1,21 @@
+#ifndef _BLENDMODE_H_
+#define _BLENDMODE_H_
+
+#include <SFML/Graphics.hpp>
+
+#include <tuple>
+
+namespace SuperEngine
+{
+    // sf::BlendMode only has == and !=, this gives it an order so draws can
+    // be sorted in to runs of the same blend mode
+    inline bool blendLess(const sf::BlendMode& a, const sf::BlendMode& b)
+    {
+        return std::tie(a.colorSrcFactor, a.colorDstFactor, a.colorEquation,
+                        a.alphaSrcFactor, a.alphaDstFactor, a.alphaEquation) <
+               std::tie(b.colorSrcFactor, b.colorDstFactor, b.colorEquation,
+                        b.alphaSrcFactor, b.alphaDstFactor, b.alphaEquation);
+    }
+};
+
+#endif // _BLENDMODE_H_
@@ -4,37 +4,35 @@
 #include <Engine.h>
 
 #include <vector>
-#include <cmath>
-
-const double RAD = M_PI / 180.f;
 
 namespace SuperEngine
 {
     class CircleEmitter: public IParticleEmitter
     {
     private:
-        struct Circle
-        {
-            sf::Vector2f position;
-            sf::Vector2f velocity;
-
-            sf::CircleShape primitive;
-        };
-
-        typedef std::vector<Circle>::iterator m_particleIter;
-        std::vector<Circle> m_particles;
+        // Every particle in one triangle list, submitted with a single draw.
+        // Kept between frames so it only allocates when the emitter grows.
+        std::vector<sf::Vertex> m_vertices;
 
-        void Add();
+        // Same circles Emitter<> draws, the shape lives in there
+        CircleRenderer m_renderer;
 
-       // Size of circle primitive
-        float m_partSize;
+        void Add(std::size_t count);
 
     public:
-        CircleEmitter();
+        explicit CircleEmitter(Engine& engine);
         ~CircleEmitter();
 
-        void setParticleSize(float val) { m_partSize = val; }
-        float getParticleSize() const { return m_partSize; }
+        void setParticleSize(float val) { m_renderer.setParticleSize(val); }
+        float getParticleSize() const { return m_renderer.getParticleSize(); }
+
+        // Edges per particle circle, tiny particles look round with very few
+        void setParticleSegments(unsigned int val) { m_renderer.setParticleSegments(val); }
+        unsigned int getParticleSegments() const { return m_renderer.getParticleSegments(); }
+
+        std::size_t getVertexCount() const final { return m_renderer.vertexCount(m_particles.count()); }
+        void writeVertices(sf::Vertex* pOut, float ahead) const final { m_renderer.write(m_particles, pOut, ahead); }
+        float getDrawExtent() const final { return m_renderer.extent(); }
 
         void Draw() final;
         void Update(float elapsedTime) final;
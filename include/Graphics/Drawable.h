@@ -5,33 +5,55 @@
 
 namespace SuperEngine
 {
+    class Engine;
+
     class Drawable
     {
     private:
+        // World this belongs to, lets several engines run side by side
+        Engine* m_pEngine;
+
         sf::Vector2f m_position, m_velocity;
         float m_direction;
         float m_rotation;
 
+        // Position before the last translate(), and the update tick it happened in.
+        // Used to draw in between fixed updates.
+        sf::Vector2f m_prevPosition;
+        unsigned long m_prevTick;
+
     public:
-        Drawable();
+        // Everything drawable belongs to an engine, pass *g_pEngine for the
+        // global one
+        explicit Drawable(Engine& engine);
         virtual ~Drawable();
 
-        sf::Vector2f getPosition() { return m_position; }
-        void setPosition(const sf::Vector2f& vec) { m_position = vec; }
-        void setPosition(float x, float y) { m_position.x = x; m_position.y = y; }
+        Engine* getEngine() const { return m_pEngine; }
+
+        // Setting the position teleports, nothing gets interpolated
+        sf::Vector2f getPosition() const { return m_position; }
+        void setPosition(const sf::Vector2f& vec) { m_position = m_prevPosition = vec; }
+        void setPosition(float x, float y) { setPosition(sf::Vector2f(x, y)); }
 
         //position on screen
         double getX() const { return m_position.x; }
         double getY() const { return m_position.y; }
-        void setX(float x) { m_position.x = x; }
-        void setY(float y) { m_position.y = y; }
+        void setX(float x) { m_position.x = m_prevPosition.x = x; }
+        void setY(float y) { m_position.y = m_prevPosition.y = y; }
+
+        // Move during an update, remembers where we came from so the
+        // render can blend between the two positions
+        void translate(const sf::Vector2f& offset);
+
+        // Position to draw at, alpha is how far we are in to the next update
+        sf::Vector2f getInterpolatedPosition(float alpha) const;
 
         void setDirection(float angle) { m_direction = angle; }
         float getDirection(void) const { return m_direction; }
 
         void setVelocity(float x = 0.0f, float y = 0.0f) {m_velocity.x = x; m_velocity.y = y; }
         void setVelocity(const sf::Vector2f& vel) { m_velocity = vel; }
-        sf::Vector2f getVelocity() { return m_velocity; }
+        sf::Vector2f getVelocity() const { return m_velocity; }
 
         void setRotation(float rot) { m_rotation = rot; }
         float getRotation() { return m_rotation; }
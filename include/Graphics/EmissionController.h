@@ -0,0 +1,56 @@
+#ifndef _EMISSIONCONTROLLER_H_
+#define _EMISSIONCONTROLLER_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace SuperEngine
+{
+    // Works out how many particles an emitter should spawn each update.
+    // A steady rate in particles per second plus any number of bursts, the
+    // fractional part of the rate carries over so 90/s at 60 updates a
+    // second really does spawn 1, 2, 1, 2...
+    class EmissionController
+    {
+    private:
+        struct Burst
+        {
+            // Seconds since the controller started
+            float time;
+            unsigned int count;
+            // 0 fires once, otherwise fires again every interval seconds
+            float interval;
+            // Doubles, so after hours of play a short interval still moves it on
+            double next;
+        };
+
+        std::vector<Burst> m_bursts;
+
+        float m_rate;
+        float m_accumulator;
+        double m_time;
+
+    public:
+        EmissionController();
+
+        // Particles per second, 0 to only spawn with bursts
+        void setRate(float particlesPerSecond) { m_rate = particlesPerSecond; }
+        float getRate() const { return m_rate; }
+
+        // Spawns count particles at time seconds, repeating every interval if it isnt 0
+        void addBurst(float time, unsigned int count, float interval = 0.f);
+        void clearBursts() { m_bursts.clear(); }
+
+        // Starts the clock again, bursts that already fired will fire again
+        void reset();
+
+        // Advances time and returns how many particles are due, at most
+        // room. Anything over room is dropped rather than owed. rateScale
+        // thins out the rate and bursts, used for level of detail.
+        std::size_t Tick(float elapsedTime, std::size_t room, float rateScale = 1.f);
+
+        double getTime() const { return m_time; }
+    };
+};
+
+#endif // _EMISSIONCONTROLLER_H_
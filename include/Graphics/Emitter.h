@@ -0,0 +1,92 @@
+#ifndef _EMITTER_H_
+#define _EMITTER_H_
+
+#include <Graphics/EmitterPolicies.h>
+
+namespace SuperEngine
+{
+    // An emitter put together at compile time from policies, see
+    // EmitterPolicies.h. Only Add/Update/Draw are virtual, everything they
+    // call per particle is inlined, so the loops vectorise for each
+    // combination. Still an IParticleEmitter, so it works in a
+    // ParticleSystem next to CircleEmitter and TextureEmitter which stay
+    // around for setting things up at runtime.
+    template<typename SpawnShape, typename Motion, typename ColorPolicy, typename Renderer>
+    class Emitter: public IParticleEmitter
+    {
+    private:
+        SpawnShape m_spawn;
+        Motion m_motion;
+        ColorPolicy m_color;
+        Renderer m_renderer;
+
+        std::vector<sf::Vertex> m_vertices;
+
+        void Add(std::size_t count) final
+        {
+            SpawnWith(m_spawn, m_color, count);
+        }
+
+    public:
+        explicit Emitter(Engine& engine)
+            : IParticleEmitter(engine)
+        {
+        }
+
+        SpawnShape& getSpawn() { return m_spawn; }
+        Motion& getMotion() { return m_motion; }
+        ColorPolicy& getColor() { return m_color; }
+        Renderer& getRenderer() { return m_renderer; }
+
+        const sf::Texture* getBatchTexture() const final { return m_renderer.getTexture(); }
+        std::size_t getVertexCount() const final { return m_renderer.vertexCount(m_particles.count()); }
+        void writeVertices(sf::Vertex* pOut, float ahead) const final { m_renderer.write(m_particles, pOut, ahead); }
+        float getDrawExtent() const final { return m_renderer.extent(); }
+
+        void Update(float elapsedTime) final
+        {
+            PROFILE_SCOPE("Emitter::Update");
+
+            if(!SpawnParticles(elapsedTime))
+                return;
+
+            const sf::Vector2f origin = getPosition();
+            const float length = getLength();
+            const bool kill = hasLifetime();
+
+            IntegrateParticles(elapsedTime, [this, elapsedTime, origin, length, kill] (std::size_t b, std::size_t e)
+            {
+                m_motion.integrate(m_particles, b, e, elapsedTime, origin, length, kill);
+            });
+        }
+
+        void Draw() final;
+    };
+
+    template<typename SpawnShape, typename Motion, typename ColorPolicy, typename Renderer>
+    void Emitter<SpawnShape, Motion, ColorPolicy, Renderer>::Draw()
+    {
+        PROFILE_SCOPE("Emitter::Draw");
+
+        std::size_t vertexCount = getVertexCount();
+
+        if(vertexCount == 0 || !isVisible(getEngine()->getView()))
+            return;
+
+        float ahead = getDrawAhead();
+
+        m_vertices.resize(vertexCount);
+        writeVertices(&m_vertices[0], ahead);
+
+        sf::RenderStates states(getBlendMode());
+        states.texture = getBatchTexture();
+
+        getEngine()->DrawVertices(m_vertices, sf::Triangles, states);
+    }
+
+    // The old emitters, minus the virtual calls
+    typedef Emitter<PointSpawn, LinearMotion, RangeColor, CircleRenderer> FastCircleEmitter;
+    typedef Emitter<PointSpawn, LinearMotion, RangeColor, TextureRenderer> FastTextureEmitter;
+};
+
+#endif // _EMITTER_H_
@@ -0,0 +1,314 @@
+#ifndef _EMITTERPOLICIES_H_
+#define _EMITTERPOLICIES_H_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+const double RAD = M_PI / 180.f;
+
+namespace SuperEngine
+{
+    // Building blocks for Emitter<>. Each policy is a plain class with non
+    // virtual functions, so every combination gets compiled and inlined on
+    // its own. Policies are members of the emitter, get them with
+    // getSpawn(), getMotion(), getColor() and getRenderer() to tweak them.
+
+    // ---- Spawn shapes ----
+    // void spawn(IParticleEmitter&, Random&, float* x, float* y, float* vx, float* vy, std::size_t count)
+
+    // Every particle starts on the emitter, heading along its direction
+    // give or take the spread. Same as the old emitters.
+    class PointSpawn
+    {
+    public:
+        void spawn(IParticleEmitter& emitter, Random& random, float* pX, float* pY,
+                   float* pVx, float* pVy, std::size_t count)
+        {
+            const sf::Vector2f origin = emitter.getPosition();
+
+            velocities(emitter, random, pVx, pVy, count);
+
+            for(std::size_t i = 0; i < count; i++)
+            {
+                pX[i] = origin.x;
+                pY[i] = origin.y;
+            }
+        }
+
+        // Just the heading, other shapes use this too
+        static void velocities(IParticleEmitter& emitter, Random& random, float* pVx, float* pVy, std::size_t count)
+        {
+            const sf::Vector2f velocity = emitter.getVelocity();
+            const float spread = emitter.getSpread() / 200.f;
+            const float dir = (emitter.getDirection() - 90.f) * RAD;
+            const float dx = std::cos(dir), dy = std::sin(dir);
+
+            // Spread goes straight in to vx for now and gets turned in to
+            // velocities after, saves a scratch buffer
+            random.fillUniform(pVx, count, -spread, spread);
+
+            for(std::size_t i = 0; i < count; i++)
+            {
+                pVy[i] = (dy + pVx[i]) * velocity.y;
+                pVx[i] = (dx + pVx[i]) * velocity.x;
+            }
+        }
+    };
+
+    // Starts anywhere inside a circle around the emitter, moving like PointSpawn
+    class CircleSpawn
+    {
+    private:
+        float m_radius;
+
+    public:
+        CircleSpawn() : m_radius(10.f) {}
+
+        void setRadius(float radius) { m_radius = radius; }
+        float getRadius() const { return m_radius; }
+
+        void spawn(IParticleEmitter& emitter, Random& random, float* pX, float* pY,
+                   float* pVx, float* pVy, std::size_t count)
+        {
+            // Angle and distance go through x and y before being turned in to a position
+            random.fillUniform(pX, count, 0.f, 2.f * M_PI);
+            random.fillUniform(pY, count, 0.f, 1.f);
+
+            const sf::Vector2f origin = emitter.getPosition();
+
+            for(std::size_t i = 0; i < count; i++)
+            {
+                // sqrt keeps them spread evenly instead of bunched in the middle
+                float r = std::sqrt(pY[i]) * m_radius;
+                float a = pX[i];
+
+                pX[i] = origin.x + std::cos(a) * r;
+                pY[i] = origin.y + std::sin(a) * r;
+            }
+
+            // Positions are done, velocities are the same as a point
+            PointSpawn::velocities(emitter, random, pVx, pVy, count);
+        }
+    };
+
+    // ---- Motion ----
+    // void integrate(ParticleData&, std::size_t begin, std::size_t end, float elapsedTime,
+    //                const sf::Vector2f& origin, float length, bool kill) const
+
+    // Straight lines, the SIMD kernel the old emitters use
+    class LinearMotion
+    {
+    public:
+        void integrate(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime,
+                       const sf::Vector2f& origin, float length, bool kill) const
+        {
+            integrateParticles(particles, begin, end, elapsedTime, origin, length, kill);
+        }
+    };
+
+    // Same again with a constant pull, like gravity or wind
+    class AcceleratedMotion
+    {
+    private:
+        sf::Vector2f m_acceleration;
+
+    public:
+        AcceleratedMotion() : m_acceleration(0.f, 98.f) {}
+
+        void setAcceleration(const sf::Vector2f& acceleration) { m_acceleration = acceleration; }
+        const sf::Vector2f& getAcceleration() const { return m_acceleration; }
+
+        void integrate(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime,
+                       const sf::Vector2f& origin, float length, bool kill) const
+        {
+            float* vx = particles.vx();
+            float* vy = particles.vy();
+            const float ax = m_acceleration.x * elapsedTime;
+            const float ay = m_acceleration.y * elapsedTime;
+
+            // Simple enough for the compiler to vectorise on its own
+            for(std::size_t i = begin; i < end; i++)
+            {
+                vx[i] += ax;
+                vy[i] += ay;
+            }
+
+            integrateParticles(particles, begin, end, elapsedTime, origin, length, kill);
+        }
+    };
+
+    // ---- Colours ----
+    // void fill(IParticleEmitter&, Random&, sf::Color* pOut, std::size_t count)
+
+    // Random between the emitter's colour and alpha ranges, like the old emitters
+    class RangeColor
+    {
+    public:
+        void fill(IParticleEmitter& emitter, Random& random, sf::Color* pOut, std::size_t count)
+        {
+            const sf::Color lo = emitter.getColorMin();
+            const sf::Color hi = emitter.getColorMax();
+
+            // A chunk at a time so the random numbers never leave the cache
+            const std::size_t CHUNK = 256;
+            float r[CHUNK], g[CHUNK], b[CHUNK], a[CHUNK];
+
+            for(std::size_t start = 0; start < count; start += CHUNK)
+            {
+                std::size_t n = std::min(CHUNK, count - start);
+
+                random.fillUniform(r, n, lo.r, hi.r);
+                random.fillUniform(g, n, lo.g, hi.g);
+                random.fillUniform(b, n, lo.b, hi.b);
+                random.fillUniform(a, n, lo.a, hi.a);
+
+                for(std::size_t i = 0; i < n; i++)
+                    pOut[start + i] = sf::Color((sf::Uint8)r[i], (sf::Uint8)g[i], (sf::Uint8)b[i], (sf::Uint8)a[i]);
+            }
+        }
+    };
+
+    // Every particle the same colour, no random numbers at all
+    class FixedColor
+    {
+    private:
+        sf::Color m_color;
+
+    public:
+        FixedColor() : m_color(sf::Color::White) {}
+
+        void setColor(const sf::Color& color) { m_color = color; }
+        const sf::Color& getColor() const { return m_color; }
+
+        void fill(IParticleEmitter&, Random&, sf::Color* pOut, std::size_t count)
+        {
+            std::fill(pOut, pOut + count, m_color);
+        }
+    };
+
+    // ---- Renderers ----
+    // std::size_t vertexCount(std::size_t particles) const
+    // void write(const ParticleData&, sf::Vertex* pOut, float ahead) const
+    // const sf::Texture* getTexture() const
+    // float extent() const, how far the drawing reaches from a particle
+
+    // Flat coloured circles, CircleEmitter draws with this too
+    class CircleRenderer
+    {
+    private:
+        std::vector<sf::Vector2f> m_shape;
+        float m_size;
+        unsigned int m_segments;
+
+        void build()
+        {
+            m_shape.clear();
+
+            sf::Vector2f centre(m_size, m_size);
+
+            for(unsigned int i = 0; i < m_segments; i++)
+            {
+                float a0 = i * 2.f * M_PI / m_segments;
+                float a1 = (i + 1) * 2.f * M_PI / m_segments;
+
+                m_shape.push_back(centre);
+                m_shape.push_back(centre + sf::Vector2f(std::cos(a0), std::sin(a0)) * m_size);
+                m_shape.push_back(centre + sf::Vector2f(std::cos(a1), std::sin(a1)) * m_size);
+            }
+        }
+
+    public:
+        CircleRenderer() : m_size(1.f), m_segments(6) { build(); }
+
+        void setParticleSize(float size) { m_size = size; build(); }
+        float getParticleSize() const { return m_size; }
+        void setParticleSegments(unsigned int segments) { m_segments = segments < 3 ? 3 : segments; build(); }
+        unsigned int getParticleSegments() const { return m_segments; }
+
+        std::size_t vertexCount(std::size_t particles) const { return particles * m_shape.size(); }
+        const sf::Texture* getTexture() const { return NULL; }
+        float extent() const { return m_size * 2.f; }
+
+        void write(const ParticleData& particles, sf::Vertex* pOut, float ahead) const
+        {
+            const float* x = particles.x();
+            const float* y = particles.y();
+            const float* vx = particles.vx();
+            const float* vy = particles.vy();
+            const sf::Color* color = particles.color();
+
+            const std::size_t shapeSize = m_shape.size();
+
+            for(std::size_t i = 0; i < particles.count(); i++)
+            {
+                sf::Vector2f position(x[i] + vx[i] * ahead, y[i] + vy[i] * ahead);
+
+                for(std::size_t v = 0; v < shapeSize; v++, pOut++)
+                {
+                    pOut->position = position + m_shape[v];
+                    pOut->color = color[i];
+                }
+            }
+        }
+    };
+
+    // Tinted, centred quads of one texture, TextureEmitter draws with this too
+    class TextureRenderer
+    {
+    private:
+        const sf::Texture* m_pTexture;
+        float m_scale;
+
+    public:
+        TextureRenderer() : m_pTexture(NULL), m_scale(1.f) {}
+
+        // Not copied, has to outlive the emitter
+        void setTexture(const sf::Texture& texture) { m_pTexture = &texture; }
+        void setScale(float scale) { m_scale = scale; }
+        float getScale() const { return m_scale; }
+
+        std::size_t vertexCount(std::size_t particles) const { return m_pTexture ? particles * 6 : 0; }
+        const sf::Texture* getTexture() const { return m_pTexture; }
+
+        float extent() const
+        {
+            return m_pTexture ? std::max(m_pTexture->getSize().x, m_pTexture->getSize().y) * std::abs(m_scale) * 0.5f : 0.f;
+        }
+
+        void write(const ParticleData& particles, sf::Vertex* pOut, float ahead) const
+        {
+            if(!m_pTexture)
+                return;
+
+            const float* x = particles.x();
+            const float* y = particles.y();
+            const float* vx = particles.vx();
+            const float* vy = particles.vy();
+            const sf::Color* color = particles.color();
+
+            sf::Vector2f size((float)m_pTexture->getSize().x, (float)m_pTexture->getSize().y);
+            sf::Vector2f half = size * (m_scale * 0.5f);
+
+            const sf::Vector2f texTL(0.f, 0.f), texTR(size.x, 0.f), texBR(size.x, size.y), texBL(0.f, size.y);
+
+            for(std::size_t i = 0; i < particles.count(); i++, pOut += 6)
+            {
+                float px = x[i] + vx[i] * ahead;
+                float py = y[i] + vy[i] * ahead;
+
+                sf::Vector2f tl(px - half.x, py - half.y), tr(px + half.x, py - half.y);
+                sf::Vector2f br(px + half.x, py + half.y), bl(px - half.x, py + half.y);
+
+                pOut[0] = sf::Vertex(tl, color[i], texTL);
+                pOut[1] = sf::Vertex(tr, color[i], texTR);
+                pOut[2] = sf::Vertex(br, color[i], texBR);
+                pOut[3] = sf::Vertex(tl, color[i], texTL);
+                pOut[4] = sf::Vertex(br, color[i], texBR);
+                pOut[5] = sf::Vertex(bl, color[i], texBL);
+            }
+        }
+    };
+};
+
+#endif // _EMITTERPOLICIES_H_
@@ -3,6 +3,18 @@
 
 namespace SuperEngine
 {
+    // What an emitter does while it is outside the view
+    enum OffscreenMode
+    {
+        // Carries on as if it was on screen
+        OFFSCREEN_UPDATE,
+        // Updates every few ticks with one longer step, so it is still
+        // roughly right when it comes back in to view
+        OFFSCREEN_COARSE,
+        // Stops dead until it is visible again
+        OFFSCREEN_FREEZE
+    };
+
     class IParticleEmitter: public Drawable
     {
     private:
@@ -13,9 +25,74 @@ namespace SuperEngine
         // Distance between each particle
         unsigned int m_spread;
 
-        virtual void Add() = 0;
+        // Spawns count particles on the end of m_particles, there is always room
+        virtual void Add(std::size_t count) = 0;
 
     protected:
+        // Live particles, dead ones are swapped out so this stays packed
+        ParticleData m_particles;
+
+        // How many particles to spawn each update
+        EmissionController m_emission;
+
+        // Seconds a particle lives for, picked between the two on spawn.
+        // 0 means forever, particles then go back to the origin at getLength()
+        float m_lifeMin, m_lifeMax;
+
+        // Each emitter gets its own stream off the engine seed, so spawning
+        // doesn't touch rand() and is the same every run with the same seed
+        Random m_random;
+
+        // Spawns, moves and retires particles, shared by every emitter
+        void UpdateParticles(float elapsedTime);
+
+        // The steps of UpdateParticles, for emitters with their own motion.
+        // SpawnParticles returns false when there is nothing to move this
+        // tick, because nothing is alive or the LOD is skipping it. When a
+        // skipped tick catches up, elapsedTime is stretched to cover it.
+        bool SpawnParticles(float& elapsedTime);
+        // Runs the affectors then kernel(begin, end) over every particle, a
+        // chunk at a time so each pass hits the cache, across the job system
+        // for big emitters. Then takes out the dead if there are lifetimes.
+        // end may run past count() up to a multiple of PARTICLE_LANES.
+        template<typename Kernel>
+        void IntegrateParticles(float elapsedTime, const Kernel& kernel);
+        // The engine's job system if this update is big enough to split, or NULL
+        JobSystem* ParallelJobs() const;
+        void ApplyAffectors(std::size_t begin, std::size_t end, float elapsedTime);
+
+        // Appends count particles, placed and coloured by the given policies
+        // from EmitterPolicies.h, with lifetimes from setLifetime. Every
+        // emitter spawns through this, the built in ones with PointSpawn
+        // and RangeColor.
+        template<typename SpawnShape, typename ColorPolicy>
+        void SpawnWith(SpawnShape& spawn, ColorPolicy& color, std::size_t count);
+        void FillLifetimes(float* pLife, std::size_t count);
+
+        // Run over the particles in order before they are moved
+        std::vector<std::shared_ptr<IParticleAffector> > m_affectors;
+
+        // How the particles mix with what is already drawn
+        sf::BlendMode m_blendMode;
+
+        // Level of detail, see ParticleLOD. Scale cuts the max and the spawn
+        // rate, low scales also update every few ticks with a longer step.
+        float m_priority;
+        float m_lodScale;
+        unsigned int m_lodInterval;
+        unsigned int m_lodFrame;
+        float m_lodPending;
+
+        // Culling against the engine's view
+        OffscreenMode m_offscreenMode;
+        unsigned int m_coarseInterval;
+        bool m_onScreen;
+
+        // Emitters with at least this many particles are updated in chunks
+        // of m_parallelChunk particles across the engine's job system
+        std::size_t m_parallelThreshold;
+        std::size_t m_parallelChunk;
+
         // Cant be bothered to write setters and getters for these
         unsigned int m_max;
         unsigned int m_alphaMin, m_alphaMax;
@@ -32,19 +109,178 @@ namespace SuperEngine
             m_minR = rmin; m_minG = gmin; m_minB = bmin;
             m_maxR = rmax; m_maxG = gmax; m_maxB = bmax;
         }
+        // The colour and alpha ranges packed up, alpha is in a
+        sf::Color getColorMin() const { return sf::Color(m_minR, m_minG, m_minB, m_alphaMin); }
+        sf::Color getColorMax() const { return sf::Color(m_maxR, m_maxG, m_maxB, m_alphaMax); }
+
+        // Particles die after a random time between minSeconds and maxSeconds,
+        // or when they pass getLength(). Pass 0 to keep them forever.
+        void setLifetime(float minSeconds, float maxSeconds) { m_lifeMin = minSeconds; m_lifeMax = maxSeconds; }
+        void setLifetime(float seconds) { setLifetime(seconds, seconds); }
+        float getLifetimeMin() const { return m_lifeMin; }
+        float getLifetimeMax() const { return m_lifeMax; }
+        bool hasLifetime() const { return m_lifeMax > 0.f; }
+
+        // Particles per second, and extra particles at set times
+        void setEmissionRate(float particlesPerSecond) { m_emission.setRate(particlesPerSecond); }
+        float getEmissionRate() const { return m_emission.getRate(); }
+        void addBurst(float time, unsigned int count, float interval = 0.f) { m_emission.addBurst(time, count, interval); }
+        EmissionController& getEmission() { return m_emission; }
+
+        // Overrides the stream handed out by the engine
+        void setRandomSeed(std::uint64_t seed) { m_random.seed(seed); }
+        Random& getRandom() { return m_random; }
+
+        // Split the update across worker threads once there are at least
+        // threshold particles, 0 keeps it on the calling thread. Chunks are
+        // rounded up to whole cache lines.
+        void setParallelThreshold(std::size_t threshold) { m_parallelThreshold = threshold; }
+        std::size_t getParallelThreshold() const { return m_parallelThreshold; }
+        void setParallelChunk(std::size_t particles);
+        std::size_t getParallelChunk() const { return m_parallelChunk; }
+
+        // Affectors can be shared between emitters
+        void addAffector(const std::shared_ptr<IParticleAffector>& pAffector) { m_affectors.push_back(pAffector); }
+        void removeAffector(const std::shared_ptr<IParticleAffector>& pAffector);
+        void clearAffectors() { m_affectors.clear(); }
+        std::size_t getAffectorCount() const { return m_affectors.size(); }
+
+        // 0 to 1, how much an emitter is spared when the LOD has to cut back.
+        // 1 is never touched.
+        void setPriority(float val) { m_priority = val; }
+        float getPriority() const { return m_priority; }
+        // 1 is full detail, set by ParticleLOD
+        void setLodScale(float scale);
+        float getLodScale() const { return m_lodScale; }
+        // Most particles allowed right now, the max with the LOD applied
+        std::size_t getEffectiveMax() const;
+
+        // Everywhere a particle can be drawn, the position give or take the
+        // length, how far it can be drawn ahead and how big it is drawn
+        sf::FloatRect getBounds() const;
+        // True if the bounds overlap the view at all, or the view has no size
+        bool isVisible(const sf::View& view) const;
+        // Whether the last update found the emitter in the engine's view
+        bool isOnScreen() const { return m_onScreen; }
+
+        void setOffscreenMode(OffscreenMode mode) { m_offscreenMode = mode; }
+        OffscreenMode getOffscreenMode() const { return m_offscreenMode; }
+        // Ticks between coarse updates when off screen
+        void setCoarseInterval(unsigned int ticks) { m_coarseInterval = ticks < 1 ? 1 : ticks; }
+        unsigned int getCoarseInterval() const { return m_coarseInterval; }
+
+        // Runs the emitter for the given time straight away, so it starts out
+        // looking like it has been going for a while. Ignores culling.
+        void prewarm(float seconds, float step = 1.f / 60.f);
+
+        // Saves the particles, relative to the emitter, to load back in
+        // later instead of prewarming every time
+        void saveSnapshot(std::vector<char>& out) const;
+        bool saveSnapshot(const std::string& filename) const;
+        // Replaces the particles with a snapshot, moved to where the emitter
+        // is now. Anything past the max is left out.
+        bool loadSnapshot(const char* pData, std::size_t size);
+        bool loadSnapshot(const std::vector<char>& data) { return data.empty() ? false : loadSnapshot(&data[0], data.size()); }
+        bool loadSnapshot(const std::string& filename);
+
+        // How far ahead of the last update to draw particles, covers the
+        // engine's interpolation and any ticks the LOD skipped
+        float getDrawAhead() const;
+        // Most getDrawAhead() can reach before the next real update
+        float getMaxDrawAhead() const;
+
+        void setBlendMode(sf::BlendMode mode) { m_blendMode = mode; }
+        sf::BlendMode getBlendMode() const { return m_blendMode; }
+
+        // Takes particle storage from a shared arena, ParticleSystem does this
+        void setArena(ParticleArena* pArena) { m_particles.setArena(pArena); }
+
+        // Batching, emitters with the same texture and blend mode can write
+        // their triangles in to one vertex array and share a draw call
+        virtual const sf::Texture* getBatchTexture() const { return NULL; }
+        // Triangle vertices needed for the current particles
+        virtual std::size_t getVertexCount() const = 0;
+        // Writes getVertexCount() vertices, particles are moved ahead along
+        // their velocity by the given time
+        virtual void writeVertices(sf::Vertex* pOut, float ahead) const = 0;
+        // How far a particle's drawing reaches from its position
+        virtual float getDrawExtent() const = 0;
+
+        std::size_t getParticleCount() const { return m_particles.count(); }
+        void clearParticles() { m_particles.clear(); }
 
         void setSpread(unsigned int val) { m_spread = val; }
         unsigned int getSpread() { return m_spread; }
         void setLength(float val) { m_length = val; }
-        unsigned int getLength() { return m_length; }
+        unsigned int getLength() const { return m_length; }
 
 
-        IParticleEmitter();
-        virtual ~IParticleEmitter() {}
+        explicit IParticleEmitter(Engine& engine);
+        virtual ~IParticleEmitter() { m_particles.release(); }
 
         virtual void Draw() = 0;
         virtual void Update(float elapsedTime) = 0;
     };
+
+    template<typename Kernel>
+    void IParticleEmitter::IntegrateParticles(float elapsedTime, const Kernel& kernel)
+    {
+        // Padding past the last particle is part of the allocation, so the
+        // kernel can run whole SIMD widths
+        std::size_t end = std::min(m_particles.capacity(),
+            (m_particles.count() + ParticleData::PARTICLE_LANES - 1) / ParticleData::PARTICLE_LANES * ParticleData::PARTICLE_LANES);
+
+        // Affectors and the kernel go a chunk at a time, so the velocities
+        // are still in cache when the kernel reads them
+        auto chunked = [this, elapsedTime, &kernel] (std::size_t b, std::size_t e)
+        {
+            const std::size_t CHUNK = 1024;
+
+            for(std::size_t i = b; i < e; i += CHUNK)
+            {
+                std::size_t chunkEnd = std::min(i + CHUNK, e);
+
+                ApplyAffectors(i, chunkEnd, elapsedTime);
+                kernel(i, chunkEnd);
+            }
+        };
+
+        if(JobSystem* pJobs = ParallelJobs())
+        {
+            PROFILE_SCOPE("IParticleEmitter::ParallelUpdate");
+
+            // Chunks are whole cache lines, so no two threads write to the same one
+            pJobs->parallel_for(0, end, m_parallelChunk, chunked);
+        }
+        else if(m_affectors.empty())
+            kernel(0, end);
+        else
+            chunked(0, end);
+
+        // Compaction moves particles between chunks, so it stays serial
+        if(hasLifetime())
+            m_particles.removeDead();
+    }
+
+    template<typename SpawnShape, typename ColorPolicy>
+    void IParticleEmitter::SpawnWith(SpawnShape& spawn, ColorPolicy& color, std::size_t count)
+    {
+        std::size_t first = m_particles.append(count);
+        std::size_t last = m_particles.count();
+
+        // Big spawns go in chunks, so each policy's pass is still in cache for the next
+        const std::size_t CHUNK = 256;
+
+        for(std::size_t i = first; i < last; i += CHUNK)
+        {
+            std::size_t n = std::min(CHUNK, last - i);
+
+            spawn.spawn(*this, m_random, m_particles.x() + i, m_particles.y() + i,
+                        m_particles.vx() + i, m_particles.vy() + i, n);
+            color.fill(*this, m_random, m_particles.color() + i, n);
+            FillLifetimes(m_particles.life() + i, n);
+        }
+    }
 };
 
 #endif // _PARTICLEEMITTER_H_
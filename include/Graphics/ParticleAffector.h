@@ -0,0 +1,117 @@
+#ifndef _PARTICLEAFFECTOR_H_
+#define _PARTICLEAFFECTOR_H_
+
+namespace SuperEngine
+{
+    // Changes particle velocities before they are moved, one pass over the
+    // arrays per affector. Add them to an emitter with addAffector(), they
+    // run in the order they were added. One affector can be shared by many
+    // emitters, Apply() may be called from several threads at once so it
+    // must not change the affector itself.
+    class IParticleAffector
+    {
+    private:
+        bool m_enabled;
+
+    public:
+        IParticleAffector() : m_enabled(true) {}
+        virtual ~IParticleAffector() {}
+
+        void setEnabled(bool val) { m_enabled = val; }
+        bool isEnabled() const { return m_enabled; }
+
+        // Works on [begin, end), time is how long the emitter has been running
+        virtual void Apply(ParticleData& particles, std::size_t begin, std::size_t end,
+                           float elapsedTime, float time) const = 0;
+    };
+
+    // Constant acceleration, in pixels per second squared
+    class GravityAffector: public IParticleAffector
+    {
+    private:
+        sf::Vector2f m_acceleration;
+
+    public:
+        explicit GravityAffector(const sf::Vector2f& acceleration = sf::Vector2f(0.f, 98.f))
+            : m_acceleration(acceleration) {}
+
+        void setAcceleration(const sf::Vector2f& acceleration) { m_acceleration = acceleration; }
+        const sf::Vector2f& getAcceleration() const { return m_acceleration; }
+
+        void Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float time) const;
+    };
+
+    // Slows particles down, coefficient is the fraction of speed lost per second
+    class DragAffector: public IParticleAffector
+    {
+    private:
+        float m_coefficient;
+
+    public:
+        explicit DragAffector(float coefficient = 0.5f) : m_coefficient(coefficient) {}
+
+        void setCoefficient(float val) { m_coefficient = val; }
+        float getCoefficient() const { return m_coefficient; }
+
+        void Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float time) const;
+    };
+
+    // Pulls particles towards a point with a constant strength, negative
+    // strength pushes them away. Radius 0 reaches everywhere.
+    class AttractorAffector: public IParticleAffector
+    {
+    protected:
+        sf::Vector2f m_position;
+        float m_strength;
+        float m_radius;
+
+    public:
+        AttractorAffector(const sf::Vector2f& position = sf::Vector2f(), float strength = 100.f, float radius = 0.f)
+            : m_position(position), m_strength(strength), m_radius(radius) {}
+
+        void setPosition(const sf::Vector2f& position) { m_position = position; }
+        const sf::Vector2f& getPosition() const { return m_position; }
+        void setStrength(float val) { m_strength = val; }
+        float getStrength() const { return m_strength; }
+        void setRadius(float val) { m_radius = val; }
+        float getRadius() const { return m_radius; }
+
+        void Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float time) const;
+    };
+
+    // Spins particles around a point, positive strength goes clockwise on
+    // screen. Same settings as an attractor.
+    class VortexAffector: public AttractorAffector
+    {
+    public:
+        VortexAffector(const sf::Vector2f& position = sf::Vector2f(), float strength = 100.f, float radius = 0.f)
+            : AttractorAffector(position, strength, radius) {}
+
+        void Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float time) const;
+    };
+
+    // Pushes particles around with smooth noise so they wander. Scale is the
+    // size of the swirls in pixels, speed is how fast the pattern changes.
+    class TurbulenceAffector: public IParticleAffector
+    {
+    private:
+        float m_strength;
+        float m_scale;
+        float m_speed;
+
+    public:
+        TurbulenceAffector(float strength = 50.f, float scale = 64.f, float speed = 1.f)
+            : m_strength(strength), m_scale(scale), m_speed(speed) {}
+
+        void setStrength(float val) { m_strength = val; }
+        float getStrength() const { return m_strength; }
+        void setScale(float val) { m_scale = val; }
+        float getScale() const { return m_scale; }
+        void setSpeed(float val) { m_speed = val; }
+        float getSpeed() const { return m_speed; }
+
+        void Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float time) const;
+    };
+};
+
+#endif // _PARTICLEAFFECTOR_H_
@@ -0,0 +1,163 @@
+#ifndef _PARTICLEDATA_H_
+#define _PARTICLEDATA_H_
+
+#include <SFML/Graphics.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+
+namespace SuperEngine
+{
+    // Particles stored as structure of arrays, every attribute is its own
+    // packed array so update kernels can stream through them with SIMD.
+    // All arrays live in one allocation, each starts on a cache line
+    // and the capacity is always a multiple of PARTICLE_LANES, so kernels
+    // may read and write past count() up to capacity() without checking.
+    class ParticleData
+    {
+    public:
+        static const std::size_t PARTICLE_LANES = 8;
+        // Floats per cache line, ranges split on multiples of this never
+        // share a line so threads can work on them side by side
+        static const std::size_t PARTICLE_CACHE_LINE = 16;
+
+    private:
+        void* m_pBlock;
+
+        // Where the block comes from, NULL for the heap
+        ParticleArena* m_pArena;
+
+        float* m_x;
+        float* m_y;
+        float* m_vx;
+        float* m_vy;
+        // Seconds alive and seconds to live, a particle is dead once age >= life
+        float* m_age;
+        float* m_life;
+        sf::Color* m_color;
+
+        std::size_t m_count;
+        std::size_t m_capacity;
+
+        static std::atomic<std::size_t> s_blocksAllocated;
+
+        ParticleData(const ParticleData&);
+        ParticleData& operator=(const ParticleData&);
+
+    public:
+        ParticleData();
+        ~ParticleData();
+
+        // Grows the arrays, keeps existing particles. Never shrinks.
+        bool reserve(std::size_t capacity);
+        void release();
+
+        // Blocks every ParticleData has taken from the heap or an arena so
+        // far, to check particle storage isn't reallocated every frame
+        static std::size_t getBlocksAllocated() { return s_blocksAllocated; }
+
+        // Takes storage from an arena instead of the heap. Drops any
+        // particles already stored, so set it before adding any.
+        void setArena(ParticleArena* pArena);
+        ParticleArena* getArena() const { return m_pArena; }
+
+        // Returns the new particle's index, or -1 if there is no room left
+        int add(float x, float y, float vx, float vy, const sf::Color& color, float life = INFINITY)
+        {
+            if(m_count >= m_capacity)
+                return -1;
+
+            m_x[m_count] = x;
+            m_y[m_count] = y;
+            m_vx[m_count] = vx;
+            m_vy[m_count] = vy;
+            m_age[m_count] = 0.f;
+            m_life[m_count] = life;
+            m_color[m_count] = color;
+
+            return m_count++;
+        }
+
+        // Adds up to count particles in one go with their age zeroed, fill in
+        // the rest of the arrays from the returned index up to count()
+        std::size_t append(std::size_t count)
+        {
+            std::size_t first = m_count;
+
+            if(count > m_capacity - m_count)
+                count = m_capacity - m_count;
+
+            for(std::size_t i = first; i < first + count; i++)
+                m_age[i] = 0.f;
+
+            m_count += count;
+
+            return first;
+        }
+
+        // Moves the last particle in to the slot, so order isn't kept
+        void kill(std::size_t index)
+        {
+            std::size_t last = --m_count;
+
+            m_x[index] = m_x[last];
+            m_y[index] = m_y[last];
+            m_vx[index] = m_vx[last];
+            m_vy[index] = m_vy[last];
+            m_age[index] = m_age[last];
+            m_life[index] = m_life[last];
+            m_color[index] = m_color[last];
+        }
+
+        // Appends every particle to out as a flat binary blob, positions are
+        // stored relative to origin so it can be loaded somewhere else
+        void writeSnapshot(std::vector<char>& out, const sf::Vector2f& origin) const;
+        // Replaces the particles with a blob from writeSnapshot, moved to
+        // origin. Each array is one memcpy. Loads at most maxCount particles,
+        // growing the storage if needed. False if it isn't a snapshot.
+        bool readSnapshot(const char* pData, std::size_t size, const sf::Vector2f& origin, std::size_t maxCount);
+
+        // Drops particles off the end until there are at most count left
+        void truncate(std::size_t count) { if(count < m_count) m_count = count; }
+
+        // Kills every particle whose age has reached its life, returns how many
+        std::size_t removeDead();
+
+        void clear() { m_count = 0; }
+
+        std::size_t count() const { return m_count; }
+        std::size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_count == 0; }
+
+        float* x() { return m_x; }
+        float* y() { return m_y; }
+        float* vx() { return m_vx; }
+        float* vy() { return m_vy; }
+        float* age() { return m_age; }
+        float* life() { return m_life; }
+        sf::Color* color() { return m_color; }
+
+        const float* x() const { return m_x; }
+        const float* y() const { return m_y; }
+        const float* vx() const { return m_vx; }
+        const float* vy() const { return m_vy; }
+        const float* age() const { return m_age; }
+        const float* life() const { return m_life; }
+        const sf::Color* color() const { return m_color; }
+    };
+
+    // Moves particles along their velocity and ages them. Any particle further
+    // than maxDistance from the origin is put back on the origin, or when
+    // killOutside is set, is aged to death so removeDead() takes it out.
+    // Uses AVX when the compiler targets it, SSE otherwise, plain C++ on
+    // anything else. The default build flags only give SSE, the 8 wide AVX
+    // path needs make SIMD=-mavx (or -mavx in the Code::Blocks target) and
+    // a CPU that has it. Works on [begin, end), end may be rounded up to a
+    // multiple of PARTICLE_LANES as long as it stays within capacity.
+    void integrateParticles(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime,
+                            const sf::Vector2f& origin, float maxDistance, bool killOutside = false);
+};
+
+#endif // _PARTICLEDATA_H_
@@ -0,0 +1,65 @@
+#ifndef _PARTICLELOD_H_
+#define _PARTICLELOD_H_
+
+namespace SuperEngine
+{
+    // Keeps particles inside a frame budget. Watches how long frames take to
+    // work through, and when they run over it lowers a global quality
+    // level. Every emitter gets a share of that based on its priority and
+    // how big it is on screen, so small unimportant effects go first. When
+    // there is headroom again quality creeps back up. It drops quickly and
+    // recovers slowly so it doesn't flicker between levels.
+    class ParticleLOD
+    {
+    private:
+        bool m_enabled;
+
+        // Seconds, 0 uses the frame limit or 60 fps
+        float m_budget;
+
+        float m_quality;
+        float m_minQuality;
+        float m_step;
+
+        // Smoothed frame work time
+        float m_average;
+
+        // Frames in a row over budget, or under the headroom line
+        unsigned int m_overFrames;
+        unsigned int m_underFrames;
+
+        // How many frames it takes to drop or raise a step
+        unsigned int m_dropAfter;
+        unsigned int m_raiseAfter;
+        // Quality only goes back up below this fraction of the budget
+        float m_headroom;
+
+    public:
+        ParticleLOD();
+
+        void setEnabled(bool val) { m_enabled = val; }
+        bool isEnabled() const { return m_enabled; }
+
+        void setBudget(float milliseconds) { m_budget = milliseconds / 1000.f; }
+        float getBudget() const { return m_budget * 1000.f; }
+
+        // Never goes below this, 0 lets low priority emitters go completely
+        void setMinQuality(float val) { m_minQuality = val; }
+        float getQuality() const { return m_quality; }
+
+        // Defaults are drop after 10 bad frames, raise after 60 good ones
+        // below 80% of the budget, 10% per step
+        void setResponse(unsigned int dropAfter, unsigned int raiseAfter, float headroom, float step);
+
+        void reset();
+
+        // Call once a frame with the engine's last frame work time
+        void Update(const Engine& engine);
+
+        // Scale an emitter should run at, from the current quality, its
+        // priority and how much of the view it covers
+        float getEmitterScale(IParticleEmitter& emitter, const sf::View& view) const;
+    };
+};
+
+#endif // _PARTICLELOD_H_
@@ -0,0 +1,81 @@
+#ifndef _PARTICLESYSTEM_H_
+#define _PARTICLESYSTEM_H_
+
+#include <vector>
+#include <memory>
+
+namespace SuperEngine
+{
+    // Owns a set of emitters, updates them all in one go and draws them with
+    // as few draw calls as possible. Particle arrays come out of one arena
+    // so creating and destroying emitters doesn't keep hitting the heap.
+    class ParticleSystem
+    {
+    private:
+        Engine* m_pEngine;
+
+        // Declared before the emitters so it outlives them
+        ParticleArena m_arena;
+
+        std::vector<std::unique_ptr<IParticleEmitter> > m_emitters;
+
+        // Scratch lists, kept so a frame doesn't allocate
+        std::vector<IParticleEmitter*> m_small;
+        std::vector<IParticleEmitter*> m_drawOrder;
+        std::vector<std::vector<sf::Vertex> > m_batches;
+
+        std::size_t m_batchCount;
+        std::size_t m_culledCount;
+
+        ParticleLOD m_lod;
+
+        ParticleSystem(const ParticleSystem&);
+        ParticleSystem& operator=(const ParticleSystem&);
+
+    public:
+        explicit ParticleSystem(Engine& engine);
+        ~ParticleSystem();
+
+        // Makes an emitter owned by the system, extra arguments go to its
+        // constructor after the engine
+        template<typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            T* pEmitter = new T(*m_pEngine, std::forward<Args>(args)...);
+            pEmitter->setArena(&m_arena);
+            m_emitters.push_back(std::unique_ptr<IParticleEmitter>(pEmitter));
+
+            return pEmitter;
+        }
+
+        // Deletes the emitter, the pointer is no good after this
+        void destroy(IParticleEmitter* pEmitter);
+        void clear();
+
+        std::size_t getEmitterCount() const { return m_emitters.size(); }
+        IParticleEmitter* getEmitter(std::size_t index) { return m_emitters[index].get(); }
+        std::size_t getParticleCount() const;
+        // Draw calls the last Draw() needed
+        std::size_t getBatchCount() const { return m_batchCount; }
+        // Emitters with particles the last Draw() skipped for being off screen
+        std::size_t getCulledCount() const { return m_culledCount; }
+        ParticleArena& getArena() { return m_arena; }
+
+        // Off by default, turn on with getLOD().setEnabled(true)
+        ParticleLOD& getLOD() { return m_lod; }
+
+        // Runs the LOD first if it is on, then updates every emitter.
+        // Emitters too small to split themselves are spread across the job
+        // system, big ones are updated one after another and split their own
+        // particles across it
+        void Update(float elapsedTime);
+
+        // Emitters outside the engine's view are skipped. Emitters sharing a
+        // texture and blend mode go in one vertex array.
+        // Groups are drawn in order of texture then blend mode, within a
+        // group emitters keep the order they were created in.
+        void Draw();
+    };
+};
+
+#endif // _PARTICLESYSTEM_H_
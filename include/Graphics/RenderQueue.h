@@ -0,0 +1,118 @@
+#ifndef _RENDERQUEUE_H_
+#define _RENDERQUEUE_H_
+
+#include <SFML/Graphics.hpp>
+
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace SuperEngine
+{
+    // A recorded frame, draw calls are copied in so the simulation can carry on
+    // changing the originals while another thread plays the frame back.
+    //
+    // Nothing here is freed between frames. Drawables are copied in to chunks
+    // that are reused, vertex arrays are copied in to one pooled vertex list,
+    // and vertex buffers handed over with pushVertices are swapped in rather
+    // than copied, so a frame that looks like the last one doesn't allocate.
+    class RenderQueue
+    {
+    private:
+        enum CommandType
+        {
+            COMMAND_DRAWABLE,
+            // Range of m_vertices
+            COMMAND_VERTICES,
+            // One of m_buffers
+            COMMAND_BUFFER,
+            COMMAND_VIEW
+        };
+
+        struct Command
+        {
+            CommandType type;
+
+            // Copy living in one of the chunks, and how to destroy it
+            sf::Drawable* pDrawable;
+            void (*destroy)(sf::Drawable*);
+
+            std::size_t first, count;
+            sf::PrimitiveType primitive;
+
+            sf::RenderStates states;
+            unsigned int viewIndex;
+        };
+
+        struct Chunk
+        {
+            std::unique_ptr<char[]> data;
+            std::size_t size;
+        };
+
+        static const std::size_t CHUNK_SIZE = 64 * 1024;
+
+        std::vector<Command> m_commands;
+        std::vector<sf::View> m_views;
+
+        std::vector<Chunk> m_chunks;
+        std::size_t m_chunkIndex;
+        std::size_t m_chunkUsed;
+
+        std::vector<sf::Vertex> m_vertices;
+
+        // Buffers only grow, the first m_bufferCount are in use this frame
+        std::vector<std::vector<sf::Vertex> > m_buffers;
+        std::size_t m_bufferCount;
+
+        sf::Color m_clearColor;
+
+        // Room for bytes in the current chunk, or the next one that fits
+        void* allocate(std::size_t bytes, std::size_t align);
+
+        template<typename T>
+        static void destroy(sf::Drawable* pDrawable) { static_cast<T*>(pDrawable)->~T(); }
+
+        Command& pushCommand(CommandType type, const sf::RenderStates& states);
+
+        // Disable copying, the commands are owned by the queue
+        RenderQueue(const RenderQueue&);
+        RenderQueue& operator=(const RenderQueue&);
+
+    public:
+        RenderQueue();
+        ~RenderQueue();
+
+        // Snapshot the drawable as it is right now
+        template<typename T>
+        void push(const T& drawable, const sf::RenderStates& states)
+        {
+            void* p = allocate(sizeof(T), alignof(T));
+
+            Command& cmd = pushCommand(COMMAND_DRAWABLE, states);
+            cmd.pDrawable = new(p) T(drawable);
+            cmd.destroy = &RenderQueue::destroy<T>;
+        }
+
+        // Vertices are copied in to the pooled vertex list
+        void push(const sf::VertexArray& vertices, const sf::RenderStates& states);
+
+        // Takes the vertices without copying them, vertices is swapped with
+        // a buffer from an older frame so it keeps some capacity to refill
+        void pushVertices(std::vector<sf::Vertex>& vertices, sf::PrimitiveType primitive, const sf::RenderStates& states);
+
+        void pushView(const sf::View& view);
+
+        void setClearColor(const sf::Color& color) { m_clearColor = color; }
+        const sf::Color& getClearColor() const { return m_clearColor; }
+
+        std::size_t size() const { return m_commands.size(); }
+
+        // Clears the target and plays every recorded command on it
+        void execute(sf::RenderTarget& target) const;
+
+        void clear();
+    };
+};
+
+#endif // _RENDERQUEUE_H_
@@ -27,6 +27,10 @@ namespace SuperEngine
 
         sf::Color m_color;
 
+        // Draw order when batched, higher layers go on top
+        int m_layer;
+        sf::BlendMode m_blendMode;
+
     protected:
         sf::Sprite m_sprite;
 
@@ -98,6 +102,14 @@ namespace SuperEngine
         void setColor(float r, float g, float b, float a) { m_color = sf::Color(r, g, b, a); }
         sf::Color getColor() const { return m_color; }
 
+        // Batched sprites are drawn lowest layer first, on the same layer
+        // they may be reordered to share draw calls
+        void setLayer(int layer) { m_layer = layer; }
+        int getLayer() const { return m_layer; }
+
+        void setBlendMode(sf::BlendMode mode) { m_blendMode = mode; }
+        sf::BlendMode getBlendMode() const { return m_blendMode; }
+
 
         bool isCollidable() const { return m_collidable; }
         void setCollidable(bool value) { m_collidable = value; }
@@ -117,7 +129,7 @@ namespace SuperEngine
         const sf::Sprite* getSprite() const { return &m_sprite; }
 
         // Main methods
-        Sprite();
+        explicit Sprite(Engine& engine);
         virtual ~Sprite();
 
         bool Init();
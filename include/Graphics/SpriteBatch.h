@@ -0,0 +1,82 @@
+#ifndef _SPRITEBATCH_H_
+#define _SPRITEBATCH_H_
+
+#include <SFML/Graphics.hpp>
+
+#include <vector>
+
+namespace SuperEngine
+{
+    class Engine;
+
+    // Collects sprites during game_render and draws them with one call per
+    // run of the same texture and blend mode, instead of one call each.
+    //
+    // Lower layers are drawn first, and sprites on the same layer are drawn
+    // in the order they were added, so only runs that are already next to
+    // each other get merged. setSortByTexture() lets a layer whose sprites
+    // don't overlap be grouped by texture too, which batches better but
+    // draws them in no particular order.
+    //
+    // Anything else drawn through the engine, and view changes, flush the
+    // batch first, so sprites never move past other drawing. Layers are
+    // only sorted within one flush, not across the whole frame.
+    class SpriteBatch
+    {
+    private:
+        struct Entry
+        {
+            int layer;
+            const sf::Texture* texture;
+            sf::BlendMode blendMode;
+            // Order it was added in, keeps the sort stable
+            unsigned int index;
+            // Layer is grouped by texture, set by Flush()
+            bool byTexture;
+        };
+
+        Engine* m_pEngine;
+
+        std::vector<Entry> m_entries;
+        // Four corners per entry, already transformed, in the order added
+        std::vector<sf::Vertex> m_quads;
+
+        // Kept between frames so a frame doesn't allocate
+        std::vector<std::vector<sf::Vertex> > m_batches;
+        std::vector<sf::RenderStates> m_states;
+
+        std::size_t m_batchCount;
+
+        // Layers that are grouped by texture
+        std::vector<int> m_textureLayers;
+
+        SpriteBatch(const SpriteBatch&);
+        SpriteBatch& operator=(const SpriteBatch&);
+
+    public:
+        explicit SpriteBatch(Engine& engine);
+
+        // Queues the sprite as it is right now, it can be changed or
+        // destroyed straight after. Sprites without a texture are skipped,
+        // SFML wouldn't draw them either.
+        void add(const sf::Sprite& sprite, int layer = 0, sf::BlendMode blendMode = sf::BlendAlpha);
+
+        // Group the layer's sprites by texture and blend mode instead of
+        // keeping the order they were added in. Only for layers where it
+        // doesn't matter which sprite ends up on top.
+        void setSortByTexture(int layer, bool val);
+        bool isSortByTexture(int layer) const;
+
+        // Sorts and draws everything queued, then empties the batch
+        void Flush();
+        // Drops everything queued without drawing it
+        void clear();
+
+        bool empty() const { return m_entries.empty(); }
+        std::size_t size() const { return m_entries.size(); }
+        // Draw calls the last Flush() with anything in it needed
+        std::size_t getBatchCount() const { return m_batchCount; }
+    };
+};
+
+#endif // _SPRITEBATCH_H_
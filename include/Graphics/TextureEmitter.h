@@ -8,27 +8,41 @@ namespace SuperEngine
     class TextureEmitter: public IParticleEmitter
     {
     private:
-        std::vector<Sprite> m_particles;
-
-        void Add() final;
-
-        float m_scale;
+        void Add(std::size_t count) final;
 
+        // Loaded or copied in, unless a shared texture is used
         sf::Texture m_texture;
+        // Same quads Emitter<> draws, holds what actually gets drawn,
+        // either m_texture or a shared one
+        TextureRenderer m_renderer;
+
+        // Two triangles per particle, all drawn with one call
+        std::vector<sf::Vertex> m_vertices;
 
     public:
-        TextureEmitter();
+        explicit TextureEmitter(Engine& engine);
         ~TextureEmitter();
 
-        void setScale(float scale) { m_scale = scale; }
-        float getScale() { return m_scale; }
+        void setScale(float scale) { m_renderer.setScale(scale); }
+        float getScale() { return m_renderer.getScale(); }
 
+        // Copies the texture in to the emitter
         void setImage(sf::Texture& image);
+        // Draws with a texture owned by someone else, it has to outlive the
+        // emitter. Emitters sharing a texture can be batched together.
+        void setTexture(const sf::Texture& texture) { m_renderer.setTexture(texture); }
         // Maybe later on i can allow ID loading from the resource manager, but right now, the
         // user is responsible for managing that. Thats right user, get off your lazy ass and
         // do some work.
         bool loadImage(const std::string& filename, const sf::Color& transcolor = sf::Color(255, 0, 255));
 
+        const sf::Texture& getTexture() const { return *m_renderer.getTexture(); }
+        const sf::Texture* getBatchTexture() const final { return m_renderer.getTexture(); }
+
+        std::size_t getVertexCount() const final { return m_renderer.vertexCount(m_particles.count()); }
+        void writeVertices(sf::Vertex* pOut, float ahead) const final { m_renderer.write(m_particles, pOut, ahead); }
+        float getDrawExtent() const final { return m_renderer.extent(); }
+
         void Draw() final;
         void Update(float elapsedTime) final;
     };
@@ -0,0 +1,66 @@
+#ifndef _PARTICLEARENA_H_
+#define _PARTICLEARENA_H_
+
+#include <cstddef>
+#include <vector>
+#include <mutex>
+
+namespace SuperEngine
+{
+    // Hands out cache line aligned, zeroed blocks for particle arrays from a
+    // few big pages instead of one heap allocation per emitter. Freed blocks
+    // go on a free list and are reused by the next request that fits, so
+    // emitters coming and going don't touch the heap once it has warmed up.
+    // Every block starts with a cache line of header holding its size and
+    // the free list link, so the bookkeeping doesn't allocate either.
+    // Safe to use from several threads.
+    class ParticleArena
+    {
+    private:
+        std::vector<void*> m_pages;
+
+        // Bump pointer in to the newest page
+        char* m_pCurrent;
+        std::size_t m_remaining;
+
+        std::size_t m_pageSize;
+        std::size_t m_bytesInUse;
+
+        // Sits in the cache line in front of every block. A reused block can
+        // be bigger than what was asked for, the size is the whole block so
+        // all of it goes back on the free list.
+        struct BlockHeader
+        {
+            std::size_t size;
+            std::size_t magic;
+            BlockHeader* pNextFree;
+        };
+
+        // Freed blocks, linked through their headers
+        BlockHeader* m_pFree;
+
+        std::mutex m_mutex;
+
+        ParticleArena(const ParticleArena&);
+        ParticleArena& operator=(const ParticleArena&);
+
+    public:
+        static const std::size_t ARENA_ALIGN = 64;
+
+        explicit ParticleArena(std::size_t pageSize = 4 * 1024 * 1024);
+        ~ParticleArena();
+
+        // NULL if out of memory
+        void* allocate(std::size_t bytes);
+        // p must have come from allocate
+        void free(void* p);
+
+        // Gives every page back, anything still using the arena is left dangling
+        void release();
+
+        std::size_t getPageCount() const { return m_pages.size(); }
+        std::size_t getBytesInUse() const { return m_bytesInUse; }
+    };
+};
+
+#endif // _PARTICLEARENA_H_
@@ -20,6 +20,8 @@ namespace SuperEngine
         // if that's not the case, then this should be overriden
         bool load(const std::string& id, const std::string& filename)
         {
+            PROFILE_SCOPE("IResourceLoader::load");
+
             if(!exists(id))
             {
                 std::unique_ptr<T> resource(new T());
@@ -65,6 +67,8 @@ namespace SuperEngine
         template<typename P>
         bool load(const std::string& id, const std::string& filename, const P& secondParam)
         {
+            PROFILE_SCOPE("IResourceLoader::load");
+
             if(!exists(id))
             {
                 std::unique_ptr<T> resource(new T());
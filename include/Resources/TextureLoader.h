@@ -27,6 +27,8 @@ namespace SuperEngine
 
         bool load(const std::string& id, const sf::Image& image)
         {
+            PROFILE_SCOPE("TextureLoader::load");
+
             if(!exists(id))
             {
                 std::unique_ptr<sf::Texture> texture(new sf::Texture());
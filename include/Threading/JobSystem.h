@@ -0,0 +1,164 @@
+#ifndef _JOBSYSTEM_H_
+#define _JOBSYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SuperEngine
+{
+    class Profiler;
+
+    // Work stealing scheduler. Every worker owns a deque, it pushes and pops
+    // its own jobs from the back while idle workers steal from the front of
+    // the others. Threads that are not workers (the main thread) share one
+    // extra queue and help out whenever they wait on something.
+    //
+    // Engines share one process wide pool from getShared(), so running
+    // several engines side by side doesn't start a set of workers each.
+    class JobSystem
+    {
+    public:
+        typedef std::function<void()> Job;
+
+        // A job that can depend on other tasks, it is only scheduled once
+        // everything it depends on has finished
+        class Task
+        {
+        private:
+            friend class JobSystem;
+
+            Job m_job;
+
+            // Dependencies left, plus one that is released by submit()
+            std::atomic<int> m_pending;
+            std::atomic<bool> m_done;
+
+            std::mutex m_mutex;
+            std::vector<std::shared_ptr<Task> > m_continuations;
+
+        public:
+            explicit Task(const Job& job) : m_job(job), m_pending(1), m_done(false) { }
+
+            bool isDone() const { return m_done.load(std::memory_order_acquire); }
+        };
+
+        typedef std::shared_ptr<Task> TaskHandle;
+
+    private:
+        typedef void (*RangeFunc)(const void* pFunc, std::size_t begin, std::size_t end);
+
+        // Either a Job, or one chunk of a parallel_for. Chunks point at the
+        // caller's function instead of copying it in to a Job, so splitting
+        // work up doesn't allocate.
+        struct QueuedJob
+        {
+            Job job;
+
+            RangeFunc range;
+            const void* pFunc;
+            std::size_t begin, end;
+            std::atomic<std::size_t>* pRemaining;
+
+            // Jobs record their zones in the profiler of whoever queued them
+            Profiler* pProfiler;
+
+            QueuedJob() : range(NULL), pFunc(NULL), begin(0), end(0), pRemaining(NULL), pProfiler(NULL) { }
+        };
+
+        // Ring buffer that only grows, once it is big enough queueing
+        // doesn't allocate
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::vector<QueuedJob> jobs;
+            std::size_t head, count;
+
+            WorkQueue() : jobs(64), head(0), count(0) { }
+
+            void pushBack(QueuedJob& job);
+            bool popBack(QueuedJob& job);
+            bool popFront(QueuedJob& job);
+        };
+
+        // Queue 0 is shared by every non worker thread, worker n uses queue n + 1
+        std::vector<std::unique_ptr<WorkQueue> > m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::atomic<bool> m_running;
+        std::atomic<unsigned int> m_queuedJobs;
+
+        // Idle workers sleep here until something is pushed
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCond;
+
+        void WorkerLoop(unsigned int queueIndex);
+
+        unsigned int getLocalQueue() const;
+        void push(QueuedJob& job);
+        void push(const Job& job);
+        bool pop(unsigned int queueIndex, QueuedJob& job);
+        bool steal(unsigned int thiefIndex, QueuedJob& job);
+        static void execute(QueuedJob& job);
+
+        void schedule(const TaskHandle& task);
+        void finish(const TaskHandle& task);
+
+        template<typename Func>
+        static void callRange(const void* pFunc, std::size_t begin, std::size_t end)
+        {
+            (*static_cast<const Func*>(pFunc))(begin, end);
+        }
+
+        void ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, RangeFunc range, const void* pFunc);
+
+        JobSystem(const JobSystem&);
+        JobSystem& operator=(const JobSystem&);
+
+    public:
+        JobSystem();
+        ~JobSystem();
+
+        // numWorkers == 0 uses one worker per hardware thread, minus the caller
+        bool Init(unsigned int numWorkers = 0);
+        void Shutdown();
+
+        // The pool every engine uses unless given its own, started with
+        // numWorkers the first time and kept until nobody holds it anymore
+        static std::shared_ptr<JobSystem> getShared(unsigned int numWorkers = 0);
+
+        bool isRunning() const { return m_running; }
+        unsigned int getWorkerCount() const { return m_workers.size(); }
+
+        // Fire and forget
+        void run(const Job& job);
+
+        // Task graphs, build with createTask() and addDependency(), then submit()
+        TaskHandle createTask(const Job& job);
+        // task will not start until dependsOn has finished
+        void addDependency(const TaskHandle& task, const TaskHandle& dependsOn);
+        void submit(const TaskHandle& task);
+
+        // Runs queued jobs on the calling thread until the task is done
+        void wait(const TaskHandle& task);
+
+        // Runs one queued job on the calling thread, false if there was none
+        bool runPending();
+
+        // Splits [begin, end) in to chunks of at most grainSize and runs
+        // func(chunkBegin, chunkEnd) on every core. Blocks until all are done,
+        // the calling thread works on chunks too. func is called in place,
+        // not copied, so it can be any callable.
+        template<typename Func>
+        void parallel_for(std::size_t begin, std::size_t end, std::size_t grainSize, const Func& func)
+        {
+            ParallelFor(begin, end, grainSize, &JobSystem::callRange<Func>, &func);
+        }
+    };
+};
+
+#endif // _JOBSYSTEM_H_
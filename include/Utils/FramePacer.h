@@ -0,0 +1,48 @@
+#ifndef _FRAMEPACER_H_
+#define _FRAMEPACER_H_
+
+#include <chrono>
+
+namespace SuperEngine
+{
+    // Keeps a loop at a fixed rate without burning a core. Sleeps until just
+    // before the deadline, then spins the last bit because the OS scheduler
+    // is rarely accurate below a millisecond.
+    class FramePacer
+    {
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Clock::duration m_period;
+        Clock::duration m_spinThreshold;
+        Clock::time_point m_nextDeadline;
+
+        bool m_started;
+
+        unsigned long m_missedDeadlines;
+        // How late the last missed deadline was, in seconds
+        float m_lastLateness;
+
+    public:
+        FramePacer();
+
+        // 0 disables pacing, wait() then returns straight away
+        void setTargetFPS(unsigned int fps);
+        unsigned int getTargetFPS() const;
+
+        // Time before the deadline that is spent spinning instead of sleeping
+        void setSpinThreshold(unsigned int microseconds) { m_spinThreshold = std::chrono::microseconds(microseconds); }
+
+        // Blocks until the next frame is due, returns false if we were
+        // already past the deadline
+        bool wait();
+
+        // Starts counting from now again, use after a long pause or load
+        void reset();
+
+        unsigned long getMissedDeadlines() const { return m_missedDeadlines; }
+        float getLastLateness() const { return m_lastLateness; }
+    };
+};
+
+#endif // _FRAMEPACER_H_
@@ -0,0 +1,74 @@
+#ifndef _FRAMESTATS_H_
+#define _FRAMESTATS_H_
+
+#include <atomic>
+#include <vector>
+
+namespace SuperEngine
+{
+    // Everything is over the rolling window except the counters
+    struct FrameStatsSnapshot
+    {
+        // Totals since the engine started
+        unsigned long frames;
+        unsigned long ticks;
+        unsigned long droppedTicks;
+
+        // Rendered frames and simulation ticks per second
+        float frameRate;
+        float tickRate;
+
+        // Frame times in milliseconds
+        float meanMs;
+        float p50Ms;
+        float p95Ms;
+        float p99Ms;
+        float maxMs;
+    };
+
+    // Keeps the last few hundred frame times and publishes percentiles.
+    // One thread writes, any number of threads can read a snapshot without
+    // locking, they just retry if they caught the writer half way through.
+    class FrameStats
+    {
+    private:
+        struct Sample
+        {
+            float seconds;
+            unsigned int ticks;
+        };
+
+        std::vector<Sample> m_samples;
+        std::size_t m_next;
+        std::size_t m_count;
+
+        unsigned long m_frames;
+        unsigned long m_ticks;
+        unsigned long m_droppedTicks;
+        unsigned int m_pendingTicks;
+
+        // Scratch space for the percentiles, kept to avoid allocating every frame
+        std::vector<float> m_sorted;
+
+        // Odd while the snapshot is being written
+        std::atomic<unsigned int> m_sequence;
+        FrameStatsSnapshot m_snapshot;
+
+        void publish();
+
+    public:
+        explicit FrameStats(std::size_t windowSize = 240);
+
+        // Writer side, called by the engine loop
+        void addTick() { ++m_pendingTicks; }
+        void addDroppedTicks(unsigned long count) { m_droppedTicks += count; }
+        void addFrame(float seconds);
+
+        void reset();
+
+        // Safe from any thread
+        FrameStatsSnapshot getSnapshot() const;
+    };
+};
+
+#endif // _FRAMESTATS_H_
@@ -3,6 +3,8 @@
 
 #include <fstream>
 #include <ios>
+#include <mutex>
+#include <sstream>
 
 #define ERR "[!!] "
 #define WARN "[W] "
@@ -22,6 +24,11 @@ namespace SuperEngine
 
         bool m_writeTime;
 
+        // Several engines may log from their own threads. Each thread builds
+        // its line on its own and the whole line is written under the lock,
+        // so lines never get mixed up.
+        std::mutex m_mutex;
+
         Logger() { } // remove constructor
         Logger(Logger const&) {} // copy constructor
         void operator=(Logger const&) {} // assignment op
@@ -33,6 +40,11 @@ namespace SuperEngine
 
         std::ostream& stream() { return m_out; }
 
+        // The calling thread's unfinished line
+        std::ostringstream& line();
+        // Writes out the calling thread's line with the time in front
+        void writeLine();
+
         void writeTime();
 
         bool getWriteTime() { return m_writeTime; }
@@ -45,13 +57,13 @@ namespace SuperEngine
     template<typename T>
     Logger& operator<<(Logger& os, T val)
     {
-        os.writeTime();
-        os.stream() << val;
+        os.line() << val;
         return os;
     }
 
     // Use function pointer that uses ostream references as parameters and returns
-    // and execute it. So anything like std::endl will work.
+    // and execute it. So anything like std::endl will work. The line is
+    // written out at std::endl or std::flush.
     Logger& operator<<(Logger& os, std::ostream& (*fun)(std::ostream&));
 };
 
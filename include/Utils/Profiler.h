@@ -0,0 +1,191 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Zones are only compiled in for debug and profile builds
+#if defined(_DEBUG) || defined(SE_PROFILE)
+    #define SE_PROFILING_ENABLED
+#endif
+
+#ifdef SE_PROFILING_ENABLED
+    #define PROFILE_CONCAT_IMPL(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+    // Times everything from here to the end of the enclosing scope,
+    // name has to be a string literal, only the pointer is kept
+    #define PROFILE_SCOPE(name) SuperEngine::ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+    // Closes the current frame, call once per frame outside of any zone
+    #define PROFILE_FRAME() SuperEngine::Profiler::getCurrent().endFrame()
+#else
+    #define PROFILE_SCOPE(name)
+    #define PROFILE_FRAME()
+#endif
+
+namespace SuperEngine
+{
+    // Time spent in one zone during the last frame, zones with the same
+    // name and parent on the same thread are merged together
+    struct ZoneStats
+    {
+        std::string name;
+        std::string parent;
+        unsigned int depth;
+        unsigned int threadIndex;
+        unsigned int calls;
+        double totalMs;
+    };
+
+    // Zones go to the calling thread's current profiler. Every engine has
+    // its own and makes it current while it runs, so two engines never
+    // see each other's zones. Anything outside an engine goes to a shared
+    // default profiler.
+    class Profiler
+    {
+    private:
+        struct Record
+        {
+            const char* name;
+            const char* parent;
+            unsigned int depth;
+            long long start, end;
+        };
+
+        // Every thread writes to its own buffer, the lock is only contended
+        // for the moment endFrame() swaps the records out
+        struct ThreadBuffer
+        {
+            std::mutex mutex;
+            std::vector<Record> records;
+
+            // Only touched by the owning thread
+            std::vector<const char*> names;
+            std::vector<long long> starts;
+
+            unsigned int index;
+            std::string name;
+        };
+
+        // A zone kept for a trace capture
+        struct TraceEvent
+        {
+            const char* name;
+            unsigned int threadIndex;
+            long long start, end;
+        };
+
+        // A finished capture, handed over whole so it can be written out
+        // away from the frame
+        struct Capture
+        {
+            std::string filename;
+            long long start;
+            std::vector<std::string> threadNames;
+            std::vector<TraceEvent> events;
+            std::vector<long long> frames;
+        };
+
+        // Tells apart profilers that were created at the same address
+        unsigned int m_id;
+
+        std::mutex m_buffersMutex;
+        std::vector<std::unique_ptr<ThreadBuffer> > m_buffers;
+
+        std::atomic<bool> m_enabled;
+
+        mutable std::mutex m_frameMutex;
+        std::vector<ZoneStats> m_lastFrame;
+        unsigned long m_frameCount;
+        long long m_frameStart;
+
+        // Trace capture, events are gathered at every endFrame() until the
+        // duration is up and then written out in one go
+        bool m_capturing;
+        std::string m_captureFile;
+        long long m_captureStart, m_captureLength;
+        std::vector<TraceEvent> m_captureEvents;
+        std::vector<long long> m_captureFrames;
+
+        // Writes finished captures that endFrame() hands over
+        std::thread m_writer;
+
+        // Moves the capture out, call with m_buffersMutex held
+        void takeCapture(Capture& capture);
+        static bool writeCapture(const Capture& capture);
+
+        ThreadBuffer& getThreadBuffer();
+
+        Profiler(Profiler const&);
+        void operator=(Profiler const&);
+
+    public:
+        Profiler();
+        ~Profiler();
+
+        // The calling thread's current profiler, or the shared default
+        static Profiler& getCurrent();
+        // NULL goes back to the default, returns the one that was current
+        static Profiler* setCurrent(Profiler* pProfiler);
+
+        // Nanoseconds from a monotonic clock
+        static long long now();
+
+        void beginZone(const char* name);
+        void endZone();
+
+        // Gathers every thread's zones in to the last frame report
+        void endFrame();
+
+        // Label for the calling thread in reports and traces, in every profiler
+        static void setThreadName(const std::string& name);
+
+        // Records every zone for the next seconds of frames, then writes a
+        // trace event JSON file that chrome://tracing and Perfetto can open
+        void beginCapture(const std::string& filename, float seconds);
+        // Stops a capture early and writes what was recorded so far. A capture
+        // that runs out during endFrame() is written on a thread of its own.
+        bool endCapture();
+        bool isCapturing() const { return m_capturing; }
+
+        void setEnabled(bool val) { m_enabled = val; }
+        bool isEnabled() const { return m_enabled; }
+
+        unsigned long getFrameCount() const { return m_frameCount; }
+
+        // Copy of the last finished frame, ordered by thread then call tree
+        std::vector<ZoneStats> getLastFrame() const;
+
+        // Prints the last frame as an indented tree
+        void report(std::ostream& out) const;
+    };
+
+    // RAII helper behind PROFILE_SCOPE, the zone closes on the profiler it
+    // was opened on even if the current one changes in between
+    class ProfileScope
+    {
+    private:
+        Profiler& m_profiler;
+
+    public:
+        explicit ProfileScope(const char* name) : m_profiler(Profiler::getCurrent()) { m_profiler.beginZone(name); }
+        ~ProfileScope() { m_profiler.endZone(); }
+    };
+
+    // Makes a profiler current for the rest of the scope
+    class ProfilerBinding
+    {
+    private:
+        Profiler* m_pPrevious;
+
+    public:
+        explicit ProfilerBinding(Profiler& profiler) : m_pPrevious(Profiler::setCurrent(&profiler)) { }
+        ~ProfilerBinding() { Profiler::setCurrent(m_pPrevious); }
+    };
+};
+
+#endif // _PROFILER_H_
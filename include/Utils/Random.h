@@ -0,0 +1,56 @@
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace SuperEngine
+{
+    // xoshiro128+ random numbers, way faster than rand() and every stream
+    // has its own state so it is fine to use from any thread as long as each
+    // thread uses its own stream. The state is four interleaved generators
+    // so fillUniform can run them side by side with SSE. The same seed gives
+    // the same numbers with or without SSE.
+    class Random
+    {
+    private:
+        // m_state[word][lane]
+        alignas(16) std::uint32_t m_state[4][4];
+
+        // Read by whichever thread first asks for its stream, so atomic
+        static std::atomic<std::uint64_t> s_threadSeed;
+
+    public:
+        explicit Random(std::uint64_t seed = 0);
+
+        // Spreads the seed over the whole state with SplitMix64, so seeds
+        // that are close together still give unrelated streams
+        void seed(std::uint64_t seed);
+
+        // Jumbles a seed and a stream number into a new seed, use to give
+        // every emitter its own stream from one engine seed
+        static std::uint64_t mix(std::uint64_t seed, std::uint64_t stream);
+
+        std::uint32_t next();
+
+        // [0, 1)
+        float nextFloat() { return (next() >> 8) * (1.f / 16777216.f); }
+        // [minVal, maxVal)
+        float range(float minVal, float maxVal) { return minVal + (maxVal - minVal) * nextFloat(); }
+        // [minVal, maxVal), returns minVal if the range is empty
+        int rangeInt(int minVal, int maxVal);
+
+        // Fills count floats in [minVal, maxVal), much faster than calling
+        // nextFloat in a loop when there are lots to make
+        void fillUniform(float* pOut, std::size_t count, float minVal = 0.f, float maxVal = 1.f);
+
+        // A stream for the calling thread, for work that isnt tied to an
+        // emitter. Threads are seeded from setThreadSeed in the order they
+        // first ask, so only single threaded use is reproducible.
+        static Random& getThreadStream();
+        static void setThreadSeed(std::uint64_t seed) { s_threadSeed = seed; }
+    };
+};
+
+#endif // _RANDOM_H_
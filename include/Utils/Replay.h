@@ -0,0 +1,87 @@
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include <SFML/Window.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace SuperEngine
+{
+    // Records everything that makes a session non deterministic, the RNG seed,
+    // the input events and how much time passed each frame, in to a small
+    // binary log. Playing the log back gives the exact same sequence of
+    // game_update calls.
+    //
+    // Layout, host byte order:
+    //   header  "SERP", u16 version, u32 seed
+    //   frame   f32 frame time, u16 event count, events
+    //   event   u8 type, then a payload that depends on the type
+    class Replay
+    {
+    public:
+        enum Mode
+        {
+            REPLAY_NONE,
+            REPLAY_RECORDING,
+            REPLAY_PLAYING
+        };
+
+    private:
+        Mode m_mode;
+
+        std::ofstream m_out;
+        std::ifstream m_in;
+
+        unsigned int m_seed;
+
+        // Events polled since the last frame was written
+        std::vector<sf::Event> m_pendingEvents;
+
+        // Frame that is being played back
+        bool m_frameLoaded;
+        float m_frameTime;
+        std::vector<sf::Event> m_frameEvents;
+        std::size_t m_nextEvent;
+
+        unsigned long m_frameCount;
+
+        template<typename T>
+        void write(T value) { m_out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+        template<typename T>
+        bool read(T& value) { return (bool)m_in.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+
+        void writeEvent(const sf::Event& event);
+        bool readEvent(sf::Event& event);
+
+    public:
+        Replay();
+        ~Replay();
+
+        bool record(const std::string& filename, unsigned int seed);
+        bool play(const std::string& filename);
+        void stop();
+
+        Mode getMode() const { return m_mode; }
+        bool isRecording() const { return m_mode == REPLAY_RECORDING; }
+        bool isPlaying() const { return m_mode == REPLAY_PLAYING; }
+
+        // Seed the log was recorded with
+        unsigned int getSeed() const { return m_seed; }
+        unsigned long getFrameCount() const { return m_frameCount; }
+
+        // Recording, events are kept until the frame is written
+        void addEvent(const sf::Event& event);
+        void writeFrame(float frameTime);
+
+        // Playback, loadFrame() returns false once the log runs out
+        bool loadFrame();
+        bool pollEvent(sf::Event& event);
+        float getFrameTime() const { return m_frameTime; }
+        void endFrame();
+    };
+};
+
+#endif // _REPLAY_H_
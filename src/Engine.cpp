@@ -1,20 +1,57 @@
 #include <Engine.h>
 
+#include <atomic>
 #include <cstdlib>
 #include <sstream>
 
 namespace SuperEngine
 {
+    namespace
+    {
+        // rand() and the thread streams are shared by the whole process, only
+        // this engine seeds them so others can't clobber its seed
+        std::atomic<const Engine*> s_pSeedOwner(NULL);
+    }
+
     Engine::Engine()
-        : m_textureManager()
+        : m_pTextureManager(std::make_shared<TextureLoader>()), m_pJobSystem(std::make_shared<JobSystem>()),
+          m_spriteBatch(*this)
     {
-        // Seed random number generator
-        std::srand(std::time(0));
+        m_game.init = game_init;
+        m_game.update = game_update;
+        m_game.render = game_render;
+        m_game.end = game_end;
+        m_shutdown = false;
+
+        // Seed random number generator, replays overwrite this with the recorded seed
+        m_seed = std::time(0);
+        m_streamCount = 0;
 
         m_maximizeProcessor = false;
+        m_framePacer.setTargetFPS(60);
+        m_headless = false;
+        m_drawCallCount = 0;
+        m_frameWorkTime = 0.f;
+
+        m_workerCount = 0;
+
+        for(int i = 0; i < sf::Keyboard::KeyCount; i++)
+            m_keyState[i] = false;
+
+        m_threadedRendering = false;
+        m_pRecordQueue = NULL;
+        m_pPendingQueue = NULL;
+        m_renderQuit = false;
+        m_spriteBatching = true;
 
         this->setFPS(60);
 
+        m_accumulator = 0.f;
+        m_maxUpdatesPerFrame = 5;
+        m_interpolation = 0.f;
+        m_tickCount = 0;
+        m_droppedUpdates = 0;
+
         m_ambientColor = sf::Color(255, 255, 255, 0);
         m_clearColor = sf::Color(0, 0, 0, 255);
 
@@ -65,6 +102,46 @@ namespace SuperEngine
 
     int Engine::Init(int width, int height, int colordepth, bool fullscreen)
     {
+        ProfilerBinding profilerBinding(m_profiler);
+        Profiler::setThreadName("Main");
+
+        if(!m_recordFile.empty() && !m_replay.record(m_recordFile, m_seed))
+            return 0;
+
+        m_streamCount = 0;
+
+        // First engine to start owns the process wide seeds until it is released,
+        // other engines only get their own through makeStreamSeed()
+        const Engine* pOwner = NULL;
+
+        if(s_pSeedOwner.compare_exchange_strong(pOwner, this) || pOwner == this)
+        {
+            std::srand(m_seed);
+            Random::setThreadSeed(m_seed);
+        }
+
+        // Workers are needed by game_init already
+        if(!m_pJobSystem->isRunning())
+            m_pJobSystem = JobSystem::getShared(m_workerCount);
+
+        m_camera = Camera(sf::FloatRect(0.f, 0.f, (float)width, (float)height));
+
+        if(m_headless)
+        {
+            // No device at all, the game only gets simulated
+            if(!m_game.init()) return 0;
+
+            m_realTimer.restart();
+            m_frameStats.reset();
+
+            #ifdef _DEBUG
+            Logger::getInstance() << getVersionText() << std::endl;
+            Logger::getInstance() << INFO << "Engine initialized headless" << std::endl;
+            #endif // _DEBUG
+
+            return 1;
+        }
+
         // Initialize sf::Window
         // TODO: Implement fullscreen
 
@@ -82,13 +159,31 @@ namespace SuperEngine
             return 0;
         }
 
-        m_pDevice->setActive();
+        if(m_threadedRendering)
+        {
+            // The GL context can only be active in one thread, hand it over
+            m_pDevice->setActive(false);
+
+            m_renderQuit = false;
+            m_pRecordQueue = &m_renderQueues[0];
+            m_pPendingQueue = NULL;
+            m_renderThread = std::thread(&Engine::RenderThread, this);
+        }
+        else
+            m_pDevice->setActive();
 
 
-        if(!game_init()) return 0;
+        if(!m_game.init()) return 0;
 
         this->setClearColor(sf::Color::Black);
 
+        // Loading time doesn't count as time to simulate
+        m_updateClock.restart();
+        m_accumulator = 0.f;
+        m_framePacer.reset();
+        m_realTimer.restart();
+        m_frameStats.reset();
+
 
         #ifdef _DEBUG
         Logger::getInstance() << getVersionText() << std::endl;
@@ -100,7 +195,117 @@ namespace SuperEngine
 
     void Engine::ClearScene()
     {
-        this->m_pDevice->clear(this->getClearColor());
+        m_drawCallCount = 0;
+
+        if(m_pRecordQueue)
+        {
+            // The render thread clears when it plays the frame back
+            m_pRecordQueue->clear();
+            m_pRecordQueue->setClearColor(this->getClearColor());
+        }
+        else if(this->m_pDevice)
+            this->m_pDevice->clear(this->getClearColor());
+    }
+
+    void Engine::DrawVertices(std::vector<sf::Vertex>& vertices, sf::PrimitiveType primitive, const sf::RenderStates& states)
+    {
+        PROFILE_SCOPE("Engine::DrawVertices");
+
+        if(!m_spriteBatch.empty())
+            m_spriteBatch.Flush();
+
+        ++m_drawCallCount;
+
+        if(m_pRecordQueue)
+            m_pRecordQueue->pushVertices(vertices, primitive, states);
+        else if(m_pDevice && !vertices.empty())
+            m_pDevice->draw(&vertices[0], vertices.size(), primitive, states);
+    }
+
+    void Engine::setView(const Camera& camera)
+    {
+        m_camera = camera;
+
+        // Sprites so far were meant for the old view
+        m_spriteBatch.Flush();
+
+        if(m_pRecordQueue)
+            m_pRecordQueue->pushView(camera);
+        else if(m_pDevice)
+            m_pDevice->setView(camera);
+    }
+
+    void Engine::RenderThread()
+    {
+        ProfilerBinding profilerBinding(m_profiler);
+        Profiler::setThreadName("Render");
+
+        m_pDevice->setActive(true);
+
+        std::unique_lock<std::mutex> lock(m_renderMutex);
+
+        while(true)
+        {
+            m_renderCond.wait(lock, [this] { return m_pPendingQueue || m_renderQuit; });
+
+            if(!m_pPendingQueue)
+                break;
+
+            // The main thread never touches the pending queue, so draw unlocked
+            RenderQueue* pQueue = m_pPendingQueue;
+            lock.unlock();
+
+            {
+                PROFILE_SCOPE("Engine::RenderThread");
+                pQueue->execute(*m_pDevice);
+
+                PROFILE_SCOPE("display");
+                m_pDevice->display();
+            }
+
+            lock.lock();
+            m_pPendingQueue = NULL;
+            m_renderCond.notify_all();
+        }
+
+        m_pDevice->setActive(false);
+    }
+
+    void Engine::SubmitFrame()
+    {
+        std::unique_lock<std::mutex> lock(m_renderMutex);
+
+        // Wait for the previous frame to finish, only one frame can be in flight
+        m_renderCond.wait(lock, [this] { return !m_pPendingQueue; });
+
+        m_pPendingQueue = m_pRecordQueue;
+        m_pRecordQueue = (m_pRecordQueue == &m_renderQueues[0]) ? &m_renderQueues[1] : &m_renderQueues[0];
+
+        m_renderCond.notify_all();
+    }
+
+    void Engine::StopRenderThread()
+    {
+        if(!m_renderThread.joinable())
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(m_renderMutex);
+
+            // Let the last frame finish before stopping
+            m_renderCond.wait(lock, [this] { return !m_pPendingQueue; });
+            m_renderQuit = true;
+            m_renderCond.notify_all();
+        }
+
+        m_renderThread.join();
+
+        m_pRecordQueue = NULL;
+        m_renderQueues[0].clear();
+        m_renderQueues[1].clear();
+
+        if(m_pDevice)
+            m_pDevice->setActive(true);
     }
 
     int Engine::RenderStart()
@@ -114,6 +319,13 @@ namespace SuperEngine
             #endif // _DEBUG
             return 0;
         }
+
+        // Anything batched outside of a frame would have been cleared away
+        m_spriteBatch.clear();
+
+        // The render thread owns the context
+        if(m_pRecordQueue) return 1;
+
         if(!this->m_pDevice->setActive()) return 0;
 
         return 1;
@@ -121,6 +333,8 @@ namespace SuperEngine
 
     int Engine::RenderStop()
     {
+        PROFILE_SCOPE("Engine::RenderStop");
+
         if(!this->m_pDevice)
         {
             #ifdef _DEBUG
@@ -131,9 +345,20 @@ namespace SuperEngine
             return 0;
         }
 
+        // Whatever sprites are left go last
+        m_spriteBatch.Flush();
+
+        // Hand the recorded frame to the render thread, it displays it
+        if(m_pRecordQueue)
+        {
+            SubmitFrame();
+            return 1;
+        }
+
         // TODO:
         // Rendering has ended, display changes,
         // might need to change this later
+        PROFILE_SCOPE("display");
         this->m_pDevice->display();
 
         return 1;
@@ -141,51 +366,193 @@ namespace SuperEngine
 
     void Engine::Shutdown()
     {
-        gameover = true;
+        m_shutdown = true;
+
+        // Only the global engine owns the main loop
+        if(this == g_pEngine)
+            gameover = true;
+    }
+
+    bool Engine::replayFrom(const std::string& filename)
+    {
+        if(!m_replay.play(filename))
+            return false;
+
+        m_seed = m_replay.getSeed();
+        m_recordFile.clear();
+
+        return true;
+    }
+
+    bool Engine::pollEvent(sf::Event& event)
+    {
+        bool polled = false;
+
+        if(m_replay.isPlaying())
+            polled = m_replay.pollEvent(event);
+        else if(m_pDevice)
+            polled = m_pDevice->pollEvent(event);
+
+        if(!polled)
+            return false;
+
+        m_replay.addEvent(event);
+
+        // Track keys from events so recordings and replays agree on them
+        if((event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased) &&
+           event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount)
+            m_keyState[event.key.code] = (event.type == sf::Event::KeyPressed);
+
+        return true;
+    }
+
+    bool Engine::isKeyDown(sf::Keyboard::Key key) const
+    {
+        if(key < 0 || key >= sf::Keyboard::KeyCount)
+            return false;
+
+        // Reading the keyboard directly would not be reproducible
+        if(m_replay.getMode() != Replay::REPLAY_NONE)
+            return m_keyState[key];
+
+        return sf::Keyboard::isKeyPressed(key);
     }
 
     void Engine::Update()
     {
-        static sf::Clock timedMove;
-        static float timeSinceLastUpdate = 0.f;
+        ProfilerBinding profilerBinding(m_profiler);
+
+        // One Update() is one frame, close the last one before timing this one
+        PROFILE_FRAME();
+        PROFILE_SCOPE("Engine::Update");
+
+        // Whole loop time, including the pacer wait at the end of the last frame
+        m_frameStats.addFrame(m_realTimer.restart().asSeconds());
 
-        // process events here
+        float frameTime;
 
-        timeSinceLastUpdate += timedMove.restart().asSeconds();
-        while(timeSinceLastUpdate > m_timePerFrame)
+        if(m_replay.isPlaying())
+        {
+            // Time comes from the log, so the same number of updates run
+            if(!m_replay.loadFrame())
+            {
+                #ifdef _DEBUG
+                Logger::getInstance() << INFO << "Replay finished after " << m_replay.getFrameCount() << " frames" << std::endl;
+                #endif // _DEBUG
+
+                m_replay.stop();
+                Shutdown();
+                return;
+            }
+
+            frameTime = m_replay.getFrameTime();
+            m_replay.endFrame();
+        }
+        else if(m_headless)
+        {
+            // No waiting for the clock, one step per call as fast as the CPU allows
+            frameTime = m_timePerFrame;
+        }
+        else
+            frameTime = m_updateClock.restart().asSeconds();
+
+        // Stores the frame time with the events polled during this frame
+        m_replay.writeFrame(frameTime);
+
+        m_accumulator += frameTime;
+
+        unsigned int updates = 0;
+        while(m_accumulator >= m_timePerFrame && updates < m_maxUpdatesPerFrame)
         {
-            // Reduce time since last update, if the PC is slow, the time since last update
-            // will loop in the while, reduces lag and visual glitches.
             // If rendering is slow, it may happen that the logic update is called
             // much more frequently than the render function
-            timeSinceLastUpdate -= m_timePerFrame;
-            // process events here
+            m_accumulator -= m_timePerFrame;
+            ++updates;
+
+            // Counted first, so anything moved during this update knows which tick it was
+            ++m_tickCount;
+            m_frameStats.addTick();
 
             // Update time with supposed FPS time
-            game_update(m_timePerFrame);
+            PROFILE_SCOPE("game_update");
+            m_game.update(m_timePerFrame);
+        }
+
+        if(m_accumulator >= m_timePerFrame)
+        {
+            // Out of budget, throw away the whole steps we couldn't afford but
+            // keep the fraction so the next frame still lines up
+            unsigned long dropped = (unsigned long)(m_accumulator / m_timePerFrame);
+            m_droppedUpdates += dropped;
+            m_frameStats.addDroppedTicks(dropped);
+            m_accumulator -= dropped * m_timePerFrame;
+
+            #ifdef _DEBUG
+            Logger::getInstance() << WARN << "Engine::Update dropped " << dropped << " updates" << std::endl;
+            #endif // _DEBUG
         }
 
+        m_interpolation = m_accumulator / m_timePerFrame;
+
+        // No rendering, and nothing to pace against
+        if(m_headless)
+        {
+            // Nothing is ever going to draw these
+            m_spriteBatch.clear();
+
+            m_frameWorkTime = m_realTimer.getElapsedTime().asSeconds();
+            return;
+        }
 
         this->ClearScene();
 
         // begin rendering
         this->RenderStart();
 
-        game_render();
+        {
+            PROFILE_SCOPE("game_render");
+            m_game.render();
+        }
 
         // Done rendering
         this->RenderStop();
+
+        m_frameWorkTime = m_realTimer.getElapsedTime().asSeconds();
+
+        // Give the CPU back until the next frame is due
+        if(!m_maximizeProcessor)
+        {
+            PROFILE_SCOPE("Engine::FramePacer");
+            m_framePacer.wait();
+        }
     }
 
     void Engine::Close()
     {
-        game_end();
+        ProfilerBinding profilerBinding(m_profiler);
+
+        // The render thread may still be drawing the game's objects
+        StopRenderThread();
+
+        m_game.end();
 
         Release();
     }
 
     int Engine::Release()
     {
+        StopRenderThread();
+
+        m_replay.stop();
+
+        // The next engine to start can seed rand() and the thread streams
+        const Engine* pOwner = this;
+        s_pSeedOwner.compare_exchange_strong(pOwner, NULL);
+
+        // Let go of the workers, they stop when the last engine does.
+        // Anything queued after this runs in place.
+        m_pJobSystem = std::make_shared<JobSystem>();
+
         if(m_pDevice)
         {
             m_pDevice->setActive(false);
@@ -202,7 +569,9 @@ namespace SuperEngine
             #endif // _DEBUG
         }
 
-        m_textureManager.removeAll();
+        // Other engines may still be using shared textures
+        if(m_pTextureManager.unique())
+            m_pTextureManager->removeAll();
 
         return 1;
     }
@@ -2,12 +2,30 @@
 
 namespace SuperEngine
 {
-    Drawable::Drawable()
-        : m_position(0.f, 0.f), m_velocity(0.f, 0.f),
-        m_direction(0.f), m_rotation(0.f)
+    Drawable::Drawable(Engine& engine)
+        : m_pEngine(&engine), m_position(0.f, 0.f), m_velocity(0.f, 0.f),
+        m_direction(0.f), m_rotation(0.f),
+        m_prevPosition(0.f, 0.f), m_prevTick(0)
     {
     }
 
+    void Drawable::translate(const sf::Vector2f& offset)
+    {
+        m_prevPosition = m_position;
+        m_prevTick = m_pEngine->getTickCount();
+
+        m_position += offset;
+    }
+
+    sf::Vector2f Drawable::getInterpolatedPosition(float alpha) const
+    {
+        // Didn't move in the last update, so there's nothing to blend
+        if(m_prevTick != m_pEngine->getTickCount())
+            return m_position;
+
+        return m_prevPosition + (m_position - m_prevPosition) * alpha;
+    }
+
     Drawable::~Drawable()
     {
 
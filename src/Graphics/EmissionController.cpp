@@ -0,0 +1,78 @@
+#include <Engine.h>
+
+#include <cmath>
+
+namespace SuperEngine
+{
+    EmissionController::EmissionController()
+    {
+        // Roughly what the old one particle per update did at 60 updates a second
+        m_rate = 60.f;
+        m_accumulator = 0.f;
+        m_time = 0.0;
+    }
+
+    void EmissionController::addBurst(float time, unsigned int count, float interval)
+    {
+        Burst burst;
+        burst.time = time;
+        burst.count = count;
+        burst.interval = interval;
+        burst.next = time;
+
+        m_bursts.push_back(burst);
+    }
+
+    void EmissionController::reset()
+    {
+        m_accumulator = 0.f;
+        m_time = 0.0;
+
+        for(std::size_t i = 0; i < m_bursts.size(); i++)
+            m_bursts[i].next = m_bursts[i].time;
+    }
+
+    std::size_t EmissionController::Tick(float elapsedTime, std::size_t room, float rateScale)
+    {
+        m_time += elapsedTime;
+
+        m_accumulator += m_rate * rateScale * elapsedTime;
+
+        std::size_t due = (std::size_t)m_accumulator;
+        m_accumulator -= due;
+
+        std::size_t burstDue = 0;
+
+        for(std::size_t i = 0; i < m_bursts.size(); i++)
+        {
+            Burst& burst = m_bursts[i];
+
+            // A burst that fired once is parked at a negative time
+            if(burst.next < 0.0 || burst.next > m_time)
+                continue;
+
+            if(burst.interval > 0.f)
+            {
+                // Every firing since the last tick in one step, a long tick
+                // or a tiny interval can't leave this looping
+                double fires = std::floor((m_time - burst.next) / burst.interval) + 1.0;
+
+                burstDue += (std::size_t)fires * burst.count;
+                burst.next += fires * burst.interval;
+            }
+            else
+            {
+                burstDue += burst.count;
+                burst.next = -1.0;
+            }
+        }
+
+        due += (std::size_t)(burstDue * rateScale + 0.5f);
+
+        // Full emitters don't build up a debt to spew out later
+        if(due > room)
+            due = room;
+
+        return due;
+    }
+};
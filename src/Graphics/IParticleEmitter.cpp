@@ -1,9 +1,12 @@
 #include <Engine.h>
 
+#include <algorithm>
+#include <fstream>
+
 namespace SuperEngine
 {
-    IParticleEmitter::IParticleEmitter()
-        : Drawable()
+    IParticleEmitter::IParticleEmitter(Engine& engine)
+        : Drawable(engine), m_random(engine.makeStreamSeed())
     {
         m_max = 100;
         m_length = 100;
@@ -13,5 +16,266 @@ namespace SuperEngine
         m_minB = 0; m_maxB = 255;
 
         m_spread = 10;
+
+        m_lifeMin = m_lifeMax = 0.f;
+
+        m_blendMode = sf::BlendAlpha;
+
+        m_offscreenMode = OFFSCREEN_COARSE;
+        m_coarseInterval = 8;
+        m_onScreen = true;
+
+        m_priority = 0.5f;
+        m_lodScale = 1.f;
+        m_lodInterval = 1;
+        m_lodFrame = 0;
+        m_lodPending = 0.f;
+
+        // Below this, waking workers costs more than it saves
+        m_parallelThreshold = 32768;
+        m_parallelChunk = 8192;
+    }
+
+    void IParticleEmitter::setParallelChunk(std::size_t particles)
+    {
+        const std::size_t line = ParticleData::PARTICLE_CACHE_LINE;
+
+        m_parallelChunk = std::max(line, (particles + line - 1) / line * line);
+    }
+
+    JobSystem* IParticleEmitter::ParallelJobs() const
+    {
+        if(m_parallelThreshold == 0 || m_particles.count() < m_parallelThreshold)
+            return NULL;
+
+        JobSystem& jobs = getEngine()->getJobSystem();
+
+        return jobs.isRunning() ? &jobs : NULL;
+    }
+
+    void IParticleEmitter::removeAffector(const std::shared_ptr<IParticleAffector>& pAffector)
+    {
+        m_affectors.erase(std::remove(m_affectors.begin(), m_affectors.end(), pAffector), m_affectors.end());
+    }
+
+    void IParticleEmitter::ApplyAffectors(std::size_t begin, std::size_t end, float elapsedTime)
+    {
+        for(std::size_t i = 0; i < m_affectors.size(); i++)
+            if(m_affectors[i]->isEnabled())
+                m_affectors[i]->Apply(m_particles, begin, end, elapsedTime, m_emission.getTime());
+    }
+
+    void IParticleEmitter::FillLifetimes(float* pLife, std::size_t count)
+    {
+        if(hasLifetime())
+            m_random.fillUniform(pLife, count, m_lifeMin, m_lifeMax);
+        else
+            std::fill(pLife, pLife + count, INFINITY);
+    }
+
+    void IParticleEmitter::setLodScale(float scale)
+    {
+        m_lodScale = std::min(1.f, std::max(0.f, scale));
+
+        // Far enough down, halve or quarter how often it updates too
+        m_lodInterval = m_lodScale >= 0.5f ? 1 : (m_lodScale >= 0.25f ? 2 : 4);
+    }
+
+    std::size_t IParticleEmitter::getEffectiveMax() const
+    {
+        return (std::size_t)(m_max * m_lodScale + 0.5f);
+    }
+
+    sf::FloatRect IParticleEmitter::getBounds() const
+    {
+        // Fastest a particle leaves the emitter, affectors that speed them
+        // up later aren't covered
+        sf::Vector2f velocity = getVelocity();
+        float speed = std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y) * (1.f + m_spread / 200.f);
+
+        // Particles stay inside the length, but are drawn moved on along
+        // their velocity and reach past that by their size
+        float reach = m_length + speed * getMaxDrawAhead() + getDrawExtent() + 1.f;
+
+        return sf::FloatRect(getPosition().x - reach, getPosition().y - reach, reach * 2.f, reach * 2.f);
+    }
+
+    bool IParticleEmitter::isVisible(const sf::View& view) const
+    {
+        sf::Vector2f half = view.getSize() * 0.5f;
+
+        // No real camera, like headless with no screen size, so nothing is culled
+        if(half.x <= 0.f || half.y <= 0.f)
+            return true;
+
+        // A rotated view covers at most the circle around its corners
+        if(view.getRotation() != 0.f)
+        {
+            float radius = std::sqrt(half.x * half.x + half.y * half.y);
+            half = sf::Vector2f(radius, radius);
+        }
+
+        sf::FloatRect bounds = getBounds();
+        const sf::Vector2f& centre = view.getCenter();
+
+        return bounds.left < centre.x + half.x && bounds.left + bounds.width > centre.x - half.x &&
+               bounds.top < centre.y + half.y && bounds.top + bounds.height > centre.y - half.y;
+    }
+
+    void IParticleEmitter::prewarm(float seconds, float step)
+    {
+        PROFILE_SCOPE("IParticleEmitter::prewarm");
+
+        if(step <= 0.f)
+            return;
+
+        // Wherever the camera is, this has to run properly
+        OffscreenMode mode = m_offscreenMode;
+        m_offscreenMode = OFFSCREEN_UPDATE;
+
+        for(float t = 0.f; t < seconds; t += step)
+            Update(step);
+
+        m_offscreenMode = mode;
+    }
+
+    void IParticleEmitter::saveSnapshot(std::vector<char>& out) const
+    {
+        m_particles.writeSnapshot(out, getPosition());
+    }
+
+    bool IParticleEmitter::saveSnapshot(const std::string& filename) const
+    {
+        std::vector<char> data;
+        saveSnapshot(data);
+
+        std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+
+        if(!out.is_open() || !out.write(&data[0], data.size()))
+        {
+            Logger::getInstance() << WARN << "IParticleEmitter::saveSnapshot - Could not write " << filename << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool IParticleEmitter::loadSnapshot(const char* pData, std::size_t size)
+    {
+        if(!m_particles.readSnapshot(pData, size, getPosition(), m_max))
+        {
+            Logger::getInstance() << WARN << "IParticleEmitter::loadSnapshot - Not a particle snapshot" << std::endl;
+            return false;
+        }
+
+        // Make room for the rest now, so the first update doesn't reallocate
+        m_particles.reserve(m_max);
+
+        return true;
+    }
+
+    bool IParticleEmitter::loadSnapshot(const std::string& filename)
+    {
+        std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+
+        if(!in.is_open())
+        {
+            Logger::getInstance() << WARN << "IParticleEmitter::loadSnapshot - Could not open " << filename << std::endl;
+            return false;
+        }
+
+        // One read for the whole file
+        std::vector<char> data((std::size_t)in.tellg());
+        in.seekg(0);
+
+        if(data.empty() || !in.read(&data[0], data.size()))
+        {
+            Logger::getInstance() << WARN << "IParticleEmitter::loadSnapshot - Could not read " << filename << std::endl;
+            return false;
+        }
+
+        return loadSnapshot(data);
+    }
+
+    float IParticleEmitter::getDrawAhead() const
+    {
+        return getEngine()->getInterpolation() * getEngine()->getTimePerFrame() + m_lodPending;
+    }
+
+    float IParticleEmitter::getMaxDrawAhead() const
+    {
+        unsigned int interval = m_lodInterval;
+
+        // Same interval the last update went with
+        if(!m_onScreen && m_offscreenMode == OFFSCREEN_COARSE)
+            interval = std::max(interval, m_coarseInterval);
+
+        // Every skipped tick plus a whole frame of interpolation
+        return std::max(getDrawAhead(), interval * getEngine()->getTimePerFrame() + m_lodPending);
+    }
+
+    bool IParticleEmitter::SpawnParticles(float& elapsedTime)
+    {
+        m_onScreen = isVisible(getEngine()->getView());
+
+        unsigned int interval = m_lodInterval;
+
+        if(!m_onScreen)
+        {
+            // Nobody is looking, no time passes at all
+            if(m_offscreenMode == OFFSCREEN_FREEZE)
+                return false;
+
+            if(m_offscreenMode == OFFSCREEN_COARSE)
+                interval = std::max(interval, m_coarseInterval);
+        }
+
+        // Skipped ticks are saved up and done in one longer step
+        if(interval > 1 || m_lodPending > 0.f)
+        {
+            m_lodPending += elapsedTime;
+
+            if(++m_lodFrame < interval)
+                return false;
+
+            elapsedTime = m_lodPending;
+            m_lodPending = 0.f;
+            m_lodFrame = 0;
+        }
+
+        // Allocate everything up front, adding and killing never reallocates
+        if(m_particles.capacity() < m_max)
+            m_particles.reserve(m_max);
+
+        // Under LOD the newest particles past the cut go straight away
+        std::size_t maxAlive = getEffectiveMax();
+        m_particles.truncate(maxAlive);
+
+        // Spawn whatever the rate and bursts say is due, capped to the max allowed
+        std::size_t room = m_particles.count() < maxAlive ? maxAlive - m_particles.count() : 0;
+        std::size_t due = m_emission.Tick(elapsedTime, room, m_lodScale);
+
+        if(due > 0)
+            Add(due);
+
+        // Nothing alive, a dormant emitter costs nothing past this point
+        return !m_particles.empty();
+    }
+
+    void IParticleEmitter::UpdateParticles(float elapsedTime)
+    {
+        if(!SpawnParticles(elapsedTime))
+            return;
+
+        const sf::Vector2f origin = getPosition();
+        const float length = getLength();
+        const bool kill = hasLifetime();
+
+        // Check if the particle has passed the alowed distance from origin,
+        // if so reset particle to origin, or let it die if it has a lifetime
+        IntegrateParticles(elapsedTime, [this, elapsedTime, origin, length, kill] (std::size_t b, std::size_t e)
+        {
+            integrateParticles(m_particles, b, e, elapsedTime, origin, length, kill);
+        });
     }
 };
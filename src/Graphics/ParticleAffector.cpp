@@ -0,0 +1,197 @@
+#include <Engine.h>
+
+#include <cmath>
+
+#if defined(__SSE__)
+    #include <xmmintrin.h>
+#endif
+
+namespace SuperEngine
+{
+    namespace
+    {
+        // v += a for both velocity arrays
+        void addVelocity(ParticleData& particles, std::size_t begin, std::size_t end, float ax, float ay)
+        {
+            float* vx = particles.vx();
+            float* vy = particles.vy();
+
+            std::size_t i = begin;
+
+#if defined(__SSE__)
+            const __m128 ax4 = _mm_set1_ps(ax);
+            const __m128 ay4 = _mm_set1_ps(ay);
+
+            for(; i + 4 <= end; i += 4)
+            {
+                _mm_storeu_ps(vx + i, _mm_add_ps(_mm_loadu_ps(vx + i), ax4));
+                _mm_storeu_ps(vy + i, _mm_add_ps(_mm_loadu_ps(vy + i), ay4));
+            }
+#endif
+
+            for(; i < end; i++)
+            {
+                vx[i] += ax;
+                vy[i] += ay;
+            }
+        }
+
+        // Adds strength * dt along the unit vector to the point, or around
+        // it when spin is set. Particles outside radius are left alone.
+        void pullVelocity(ParticleData& particles, std::size_t begin, std::size_t end, const sf::Vector2f& point,
+                          float strength, float radius, bool spin)
+        {
+            const float* px = particles.x();
+            const float* py = particles.y();
+            float* vx = particles.vx();
+            float* vy = particles.vy();
+
+            // Radius 0 reaches everywhere
+            const float radiusSq = radius > 0.f ? radius * radius : INFINITY;
+            // Stops particles sat right on the point blowing up
+            const float minDistSq = 1e-4f;
+
+            std::size_t i = begin;
+
+#if defined(__SSE__)
+            const __m128 cx4 = _mm_set1_ps(point.x);
+            const __m128 cy4 = _mm_set1_ps(point.y);
+            const __m128 s4 = _mm_set1_ps(strength);
+            const __m128 r4 = _mm_set1_ps(radiusSq);
+            const __m128 min4 = _mm_set1_ps(minDistSq);
+
+            for(; i + 4 <= end; i += 4)
+            {
+                __m128 dx = _mm_sub_ps(cx4, _mm_loadu_ps(px + i));
+                __m128 dy = _mm_sub_ps(cy4, _mm_loadu_ps(py + i));
+                __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+                // Approximate 1 / distance is plenty for a force
+                __m128 scale = _mm_mul_ps(s4, _mm_rsqrt_ps(_mm_max_ps(distSq, min4)));
+                scale = _mm_and_ps(scale, _mm_cmple_ps(distSq, r4));
+
+                __m128 fx = spin ? _mm_sub_ps(_mm_setzero_ps(), dy) : dx;
+                __m128 fy = spin ? dx : dy;
+
+                _mm_storeu_ps(vx + i, _mm_add_ps(_mm_loadu_ps(vx + i), _mm_mul_ps(fx, scale)));
+                _mm_storeu_ps(vy + i, _mm_add_ps(_mm_loadu_ps(vy + i), _mm_mul_ps(fy, scale)));
+            }
+#endif
+
+            for(; i < end; i++)
+            {
+                float dx = point.x - px[i];
+                float dy = point.y - py[i];
+                float distSq = dx * dx + dy * dy;
+
+                if(distSq > radiusSq)
+                    continue;
+
+                float scale = strength / std::sqrt(std::max(distSq, minDistSq));
+
+                if(spin)
+                {
+                    vx[i] -= dy * scale;
+                    vy[i] += dx * scale;
+                }
+                else
+                {
+                    vx[i] += dx * scale;
+                    vy[i] += dy * scale;
+                }
+            }
+        }
+
+        // Smooth value noise in [-1, 1], hashed lattice with a smoothstep between
+        inline float hashLattice(int x, int y, int seed)
+        {
+            unsigned int h = (unsigned int)x * 374761393u + (unsigned int)y * 668265263u + (unsigned int)seed * 2246822519u;
+            h = (h ^ (h >> 13)) * 1274126177u;
+            h ^= h >> 16;
+
+            return (h & 0xffff) * (2.f / 65535.f) - 1.f;
+        }
+
+        inline float valueNoise(float x, float y, int seed)
+        {
+            float fx = std::floor(x), fy = std::floor(y);
+            int ix = (int)fx, iy = (int)fy;
+
+            float tx = x - fx, ty = y - fy;
+            tx = tx * tx * (3.f - 2.f * tx);
+            ty = ty * ty * (3.f - 2.f * ty);
+
+            float a = hashLattice(ix, iy, seed), b = hashLattice(ix + 1, iy, seed);
+            float c = hashLattice(ix, iy + 1, seed), d = hashLattice(ix + 1, iy + 1, seed);
+
+            float top = a + (b - a) * tx;
+            float bottom = c + (d - c) * tx;
+
+            return top + (bottom - top) * ty;
+        }
+    }
+
+    void GravityAffector::Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float) const
+    {
+        addVelocity(particles, begin, end, m_acceleration.x * elapsedTime, m_acceleration.y * elapsedTime);
+    }
+
+    void DragAffector::Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float) const
+    {
+        float* vx = particles.vx();
+        float* vy = particles.vy();
+
+        const float keep = std::max(0.f, 1.f - m_coefficient * elapsedTime);
+
+        std::size_t i = begin;
+
+#if defined(__SSE__)
+        const __m128 keep4 = _mm_set1_ps(keep);
+
+        for(; i + 4 <= end; i += 4)
+        {
+            _mm_storeu_ps(vx + i, _mm_mul_ps(_mm_loadu_ps(vx + i), keep4));
+            _mm_storeu_ps(vy + i, _mm_mul_ps(_mm_loadu_ps(vy + i), keep4));
+        }
+#endif
+
+        for(; i < end; i++)
+        {
+            vx[i] *= keep;
+            vy[i] *= keep;
+        }
+    }
+
+    void AttractorAffector::Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float) const
+    {
+        pullVelocity(particles, begin, end, m_position, m_strength * elapsedTime, m_radius, false);
+    }
+
+    void VortexAffector::Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float) const
+    {
+        pullVelocity(particles, begin, end, m_position, m_strength * elapsedTime, m_radius, true);
+    }
+
+    void TurbulenceAffector::Apply(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime, float time) const
+    {
+        const float* px = particles.x();
+        const float* py = particles.y();
+        float* vx = particles.vx();
+        float* vy = particles.vy();
+
+        const float invScale = m_scale > 0.f ? 1.f / m_scale : 1.f;
+        const float drift = time * m_speed;
+        const float push = m_strength * elapsedTime;
+
+        // Two unrelated noise fields, one per axis. Lattice lookups don't
+        // vectorise well without gathers, but it is still one tight pass.
+        for(std::size_t i = begin; i < end; i++)
+        {
+            float nx = px[i] * invScale;
+            float ny = py[i] * invScale + drift;
+
+            vx[i] += valueNoise(nx, ny, 1) * push;
+            vy[i] += valueNoise(nx + drift, ny, 2) * push;
+        }
+    }
+};
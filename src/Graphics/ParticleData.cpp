@@ -0,0 +1,356 @@
+#include <Engine.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE__)
+    #include <xmmintrin.h>
+#endif
+
+namespace SuperEngine
+{
+    namespace
+    {
+        const std::size_t PARTICLE_ALIGN = 64;
+
+        const char SNAPSHOT_MAGIC[4] = { 'S', 'E', 'P', 'S' };
+        const sf::Uint16 SNAPSHOT_VERSION = 1;
+
+        struct SnapshotHeader
+        {
+            char magic[4];
+            sf::Uint16 version;
+            sf::Uint16 reserved;
+            sf::Uint32 count;
+        };
+
+        void appendBytes(std::vector<char>& out, const void* pData, std::size_t bytes)
+        {
+            const char* p = static_cast<const char*>(pData);
+            out.insert(out.end(), p, p + bytes);
+        }
+
+        // Writes values - offset, a block at a time through the stack, out
+        // may not be aligned for floats
+        void appendRelative(std::vector<char>& out, const float* pValues, std::size_t count, float offset)
+        {
+            float block[256];
+
+            for(std::size_t first = 0; first < count; first += 256)
+            {
+                std::size_t n = std::min<std::size_t>(256, count - first);
+
+                for(std::size_t i = 0; i < n; i++)
+                    block[i] = pValues[first + i] - offset;
+
+                appendBytes(out, block, n * sizeof(float));
+            }
+        }
+
+        std::size_t alignUp(std::size_t val, std::size_t align)
+        {
+            return (val + align - 1) / align * align;
+        }
+
+        template<typename T>
+        T* alignPtr(void* p)
+        {
+            return reinterpret_cast<T*>(alignUp(reinterpret_cast<uintptr_t>(p), PARTICLE_ALIGN));
+        }
+    }
+
+    std::atomic<std::size_t> ParticleData::s_blocksAllocated(0);
+
+    ParticleData::ParticleData()
+        : m_pBlock(NULL), m_pArena(NULL), m_x(NULL), m_y(NULL), m_vx(NULL), m_vy(NULL),
+        m_age(NULL), m_life(NULL), m_color(NULL),
+        m_count(0), m_capacity(0)
+    {
+    }
+
+    ParticleData::~ParticleData()
+    {
+        release();
+    }
+
+    void ParticleData::release()
+    {
+        if(m_pArena)
+            m_pArena->free(m_pBlock);
+        else
+            std::free(m_pBlock);
+
+        m_pBlock = NULL;
+        m_x = m_y = m_vx = m_vy = m_age = m_life = NULL;
+        m_color = NULL;
+        m_count = m_capacity = 0;
+    }
+
+    void ParticleData::setArena(ParticleArena* pArena)
+    {
+        release();
+        m_pArena = pArena;
+    }
+
+    bool ParticleData::reserve(std::size_t capacity)
+    {
+        capacity = alignUp(capacity, PARTICLE_LANES);
+
+        if(capacity <= m_capacity)
+            return true;
+
+        // Six float arrays and a colour array, each padded to the alignment,
+        // plus slack to align the start of the block
+        std::size_t floatBytes = alignUp(capacity * sizeof(float), PARTICLE_ALIGN);
+        std::size_t colorBytes = alignUp(capacity * sizeof(sf::Color), PARTICLE_ALIGN);
+
+        // Arena blocks are already aligned, the heap needs the slack
+        std::size_t blockBytes = floatBytes * 6 + colorBytes + (m_pArena ? 0 : PARTICLE_ALIGN);
+        void* pBlock = m_pArena ? m_pArena->allocate(blockBytes) : std::calloc(blockBytes, 1);
+
+        if(!pBlock)
+        {
+            Logger::getInstance() << ERR << "ParticleData::reserve - Out of memory for " << capacity << " particles" << std::endl;
+            return false;
+        }
+
+        ++s_blocksAllocated;
+
+        char* p = alignPtr<char>(pBlock);
+        float* x = reinterpret_cast<float*>(p);
+        float* y = reinterpret_cast<float*>(p + floatBytes);
+        float* vx = reinterpret_cast<float*>(p + floatBytes * 2);
+        float* vy = reinterpret_cast<float*>(p + floatBytes * 3);
+        float* age = reinterpret_cast<float*>(p + floatBytes * 4);
+        float* life = reinterpret_cast<float*>(p + floatBytes * 5);
+        sf::Color* color = reinterpret_cast<sf::Color*>(p + floatBytes * 6);
+
+        if(m_count > 0)
+        {
+            std::memcpy(x, m_x, m_count * sizeof(float));
+            std::memcpy(y, m_y, m_count * sizeof(float));
+            std::memcpy(vx, m_vx, m_count * sizeof(float));
+            std::memcpy(vy, m_vy, m_count * sizeof(float));
+            std::memcpy(age, m_age, m_count * sizeof(float));
+            std::memcpy(life, m_life, m_count * sizeof(float));
+            std::memcpy(color, m_color, m_count * sizeof(sf::Color));
+        }
+
+        if(m_pArena)
+            m_pArena->free(m_pBlock);
+        else
+            std::free(m_pBlock);
+
+        m_pBlock = pBlock;
+        m_x = x;
+        m_y = y;
+        m_vx = vx;
+        m_vy = vy;
+        m_age = age;
+        m_life = life;
+        m_color = color;
+        m_capacity = capacity;
+
+        return true;
+    }
+
+    void ParticleData::writeSnapshot(std::vector<char>& out, const sf::Vector2f& origin) const
+    {
+        SnapshotHeader header;
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.reserved = 0;
+        header.count = (sf::Uint32)m_count;
+
+        out.reserve(out.size() + sizeof(header) + m_count * (sizeof(float) * 6 + sizeof(sf::Color)));
+        appendBytes(out, &header, sizeof(header));
+
+        // Positions go in relative to the origin
+        appendRelative(out, m_x, m_count, origin.x);
+        appendRelative(out, m_y, m_count, origin.y);
+
+        appendBytes(out, m_vx, m_count * sizeof(float));
+        appendBytes(out, m_vy, m_count * sizeof(float));
+        appendBytes(out, m_age, m_count * sizeof(float));
+        appendBytes(out, m_life, m_count * sizeof(float));
+        appendBytes(out, m_color, m_count * sizeof(sf::Color));
+    }
+
+    bool ParticleData::readSnapshot(const char* pData, std::size_t size, const sf::Vector2f& origin, std::size_t maxCount)
+    {
+        SnapshotHeader header;
+
+        if(size < sizeof(header))
+            return false;
+
+        std::memcpy(&header, pData, sizeof(header));
+
+        if(std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION)
+            return false;
+
+        std::size_t stored = header.count;
+
+        // Divided rather than multiplied, a bad count can't wrap size_t
+        if(stored > (size - sizeof(header)) / (sizeof(float) * 6 + sizeof(sf::Color)))
+            return false;
+
+        std::size_t count = std::min(stored, maxCount);
+
+        if(!reserve(count))
+            return false;
+
+        m_count = count;
+
+        // An empty snapshot may leave nothing allocated to copy in to
+        if(count == 0)
+            return true;
+
+        // Arrays are stored one after another, each is stored entries long
+        const char* p = pData + sizeof(header);
+        const std::size_t floatBytes = stored * sizeof(float);
+
+        std::memcpy(m_x, p, count * sizeof(float));
+        std::memcpy(m_y, p + floatBytes, count * sizeof(float));
+        std::memcpy(m_vx, p + floatBytes * 2, count * sizeof(float));
+        std::memcpy(m_vy, p + floatBytes * 3, count * sizeof(float));
+        std::memcpy(m_age, p + floatBytes * 4, count * sizeof(float));
+        std::memcpy(m_life, p + floatBytes * 5, count * sizeof(float));
+        std::memcpy(m_color, p + floatBytes * 6, count * sizeof(sf::Color));
+
+        for(std::size_t i = 0; i < count; i++)
+        {
+            m_x[i] += origin.x;
+            m_y[i] += origin.y;
+        }
+
+        return true;
+    }
+
+    std::size_t ParticleData::removeDead()
+    {
+        std::size_t removed = 0;
+
+        for(std::size_t i = 0; i < m_count; )
+        {
+            // The particle swapped in could be dead too, so check the slot again
+            if(m_age[i] >= m_life[i])
+            {
+                kill(i);
+                ++removed;
+            }
+            else
+                ++i;
+        }
+
+        return removed;
+    }
+
+    void integrateParticles(ParticleData& particles, std::size_t begin, std::size_t end, float elapsedTime,
+                            const sf::Vector2f& origin, float maxDistance, bool killOutside)
+    {
+        float* px = particles.x();
+        float* py = particles.y();
+        const float* vx = particles.vx();
+        const float* vy = particles.vy();
+        float* page = particles.age();
+
+        const float maxDistSq = maxDistance * maxDistance;
+
+        std::size_t i = begin;
+
+        // Comparing squared distances saves the square root per particle
+#if defined(__AVX__)
+        const __m256 dt8 = _mm256_set1_ps(elapsedTime);
+        const __m256 ox8 = _mm256_set1_ps(origin.x);
+        const __m256 oy8 = _mm256_set1_ps(origin.y);
+        const __m256 max8 = _mm256_set1_ps(maxDistSq);
+        const __m256 dead8 = _mm256_set1_ps(INFINITY);
+
+        for(; i + 8 <= end; i += 8)
+        {
+            __m256 x = _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), dt8));
+            __m256 y = _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), dt8));
+
+            __m256 dx = _mm256_sub_ps(x, ox8);
+            __m256 dy = _mm256_sub_ps(y, oy8);
+            __m256 out = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), max8, _CMP_GT_OQ);
+
+            __m256 age = _mm256_add_ps(_mm256_loadu_ps(page + i), dt8);
+
+            if(killOutside)
+            {
+                _mm256_storeu_ps(px + i, x);
+                _mm256_storeu_ps(py + i, y);
+                _mm256_storeu_ps(page + i, _mm256_blendv_ps(age, dead8, out));
+            }
+            else
+            {
+                _mm256_storeu_ps(px + i, _mm256_blendv_ps(x, ox8, out));
+                _mm256_storeu_ps(py + i, _mm256_blendv_ps(y, oy8, out));
+                _mm256_storeu_ps(page + i, age);
+            }
+        }
+#elif defined(__SSE__)
+        const __m128 dt4 = _mm_set1_ps(elapsedTime);
+        const __m128 ox4 = _mm_set1_ps(origin.x);
+        const __m128 oy4 = _mm_set1_ps(origin.y);
+        const __m128 max4 = _mm_set1_ps(maxDistSq);
+        const __m128 dead4 = _mm_set1_ps(INFINITY);
+
+        for(; i + 4 <= end; i += 4)
+        {
+            __m128 x = _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_loadu_ps(vx + i), dt4));
+            __m128 y = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(_mm_loadu_ps(vy + i), dt4));
+
+            __m128 dx = _mm_sub_ps(x, ox4);
+            __m128 dy = _mm_sub_ps(y, oy4);
+            __m128 out = _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), max4);
+
+            __m128 age = _mm_add_ps(_mm_loadu_ps(page + i), dt4);
+
+            // No blend before SSE4.1, select with masks instead
+            if(killOutside)
+            {
+                _mm_storeu_ps(px + i, x);
+                _mm_storeu_ps(py + i, y);
+                _mm_storeu_ps(page + i, _mm_or_ps(_mm_and_ps(out, dead4), _mm_andnot_ps(out, age)));
+            }
+            else
+            {
+                _mm_storeu_ps(px + i, _mm_or_ps(_mm_and_ps(out, ox4), _mm_andnot_ps(out, x)));
+                _mm_storeu_ps(py + i, _mm_or_ps(_mm_and_ps(out, oy4), _mm_andnot_ps(out, y)));
+                _mm_storeu_ps(page + i, age);
+            }
+        }
+#endif
+
+        for(; i < end; i++)
+        {
+            float x = px[i] + vx[i] * elapsedTime;
+            float y = py[i] + vy[i] * elapsedTime;
+
+            float dx = x - origin.x;
+            float dy = y - origin.y;
+
+            page[i] += elapsedTime;
+
+            if(dx * dx + dy * dy > maxDistSq)
+            {
+                if(killOutside)
+                    page[i] = INFINITY;
+                else
+                {
+                    x = origin.x;
+                    y = origin.y;
+                }
+            }
+
+            px[i] = x;
+            py[i] = y;
+        }
+    }
+};
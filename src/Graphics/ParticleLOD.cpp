@@ -0,0 +1,95 @@
+#include <Engine.h>
+
+#include <algorithm>
+
+namespace SuperEngine
+{
+    ParticleLOD::ParticleLOD()
+        : m_enabled(false), m_budget(0.f), m_minQuality(0.1f), m_step(0.1f),
+        m_dropAfter(10), m_raiseAfter(60), m_headroom(0.8f)
+    {
+        reset();
+    }
+
+    void ParticleLOD::setResponse(unsigned int dropAfter, unsigned int raiseAfter, float headroom, float step)
+    {
+        m_dropAfter = std::max(1u, dropAfter);
+        m_raiseAfter = std::max(1u, raiseAfter);
+        m_headroom = headroom;
+        m_step = step;
+    }
+
+    void ParticleLOD::reset()
+    {
+        m_quality = 1.f;
+        m_average = 0.f;
+        m_overFrames = 0;
+        m_underFrames = 0;
+    }
+
+    void ParticleLOD::Update(const Engine& engine)
+    {
+        if(!m_enabled)
+            return;
+
+        float budget = m_budget;
+
+        if(budget <= 0.f)
+            budget = 1.f / (engine.getFrameLimit() > 0 ? engine.getFrameLimit() : 60);
+
+        // Smoothed a little so one hitch doesn't count as a slow frame
+        float work = engine.getFrameWorkTime();
+        m_average = m_average > 0.f ? m_average * 0.8f + work * 0.2f : work;
+
+        if(m_average > budget)
+        {
+            m_underFrames = 0;
+
+            if(++m_overFrames >= m_dropAfter)
+            {
+                m_quality = std::max(m_minQuality, m_quality - m_step);
+                m_overFrames = 0;
+
+                #ifdef _DEBUG
+                Logger::getInstance() << DEBUG << "ParticleLOD - Over budget, quality down to " << m_quality << std::endl;
+                #endif // _DEBUG
+            }
+        }
+        else if(m_average < budget * m_headroom)
+        {
+            m_overFrames = 0;
+
+            if(m_quality < 1.f && ++m_underFrames >= m_raiseAfter)
+            {
+                m_quality = std::min(1.f, m_quality + m_step);
+                m_underFrames = 0;
+            }
+        }
+        else
+        {
+            // Close to the line, hold where we are
+            m_overFrames = 0;
+            m_underFrames = 0;
+        }
+    }
+
+    float ParticleLOD::getEmitterScale(IParticleEmitter& emitter, const sf::View& view) const
+    {
+        if(!m_enabled || m_quality >= 1.f)
+            return 1.f;
+
+        // Full priority is never cut back, whatever its size
+        if(emitter.getPriority() >= 1.f)
+            return 1.f;
+
+        // Share of the view the emitter can cover, anything half the view
+        // wide or more counts as full size
+        float viewSize = std::max(view.getSize().x, view.getSize().y);
+        float size = viewSize > 0.f ? std::min(1.f, emitter.getLength() * 4.f / viewSize) : 1.f;
+
+        // High priority and big on screen keep more of their detail
+        float importance = std::max(0.f, emitter.getPriority()) * (0.5f + 0.5f * size);
+
+        return 1.f - (1.f - m_quality) * (1.f - importance);
+    }
+};
@@ -0,0 +1,157 @@
+#include <Engine.h>
+
+#include <algorithm>
+
+namespace SuperEngine
+{
+    namespace
+    {
+        bool sameBatch(const IParticleEmitter* pA, const IParticleEmitter* pB)
+        {
+            return pA->getBatchTexture() == pB->getBatchTexture() && pA->getBlendMode() == pB->getBlendMode();
+        }
+
+        bool batchLess(const IParticleEmitter* pA, const IParticleEmitter* pB)
+        {
+            if(pA->getBatchTexture() != pB->getBatchTexture())
+                return pA->getBatchTexture() < pB->getBatchTexture();
+
+            return blendLess(pA->getBlendMode(), pB->getBlendMode());
+        }
+    }
+
+    ParticleSystem::ParticleSystem(Engine& engine)
+        : m_pEngine(&engine), m_batchCount(0), m_culledCount(0)
+    {
+    }
+
+    ParticleSystem::~ParticleSystem()
+    {
+        clear();
+    }
+
+    void ParticleSystem::destroy(IParticleEmitter* pEmitter)
+    {
+        for(std::size_t i = 0; i < m_emitters.size(); i++)
+        {
+            if(m_emitters[i].get() == pEmitter)
+            {
+                m_emitters.erase(m_emitters.begin() + i);
+                return;
+            }
+        }
+
+        Logger::getInstance() << WARN << "ParticleSystem::destroy - Emitter isn't owned by this system" << std::endl;
+    }
+
+    void ParticleSystem::clear()
+    {
+        m_emitters.clear();
+        m_arena.release();
+    }
+
+    std::size_t ParticleSystem::getParticleCount() const
+    {
+        std::size_t count = 0;
+
+        for(std::size_t i = 0; i < m_emitters.size(); i++)
+            count += m_emitters[i]->getParticleCount();
+
+        return count;
+    }
+
+    void ParticleSystem::Update(float elapsedTime)
+    {
+        PROFILE_SCOPE("ParticleSystem::Update");
+
+        if(m_lod.isEnabled())
+        {
+            m_lod.Update(*m_pEngine);
+
+            for(std::size_t i = 0; i < m_emitters.size(); i++)
+                m_emitters[i]->setLodScale(m_lod.getEmitterScale(*m_emitters[i], m_pEngine->getView()));
+        }
+
+        m_small.clear();
+
+        for(std::size_t i = 0; i < m_emitters.size(); i++)
+        {
+            IParticleEmitter* pEmitter = m_emitters[i].get();
+            std::size_t threshold = pEmitter->getParallelThreshold();
+
+            if(threshold > 0 && pEmitter->getParticleCount() >= threshold)
+                pEmitter->Update(elapsedTime);
+            else
+                m_small.push_back(pEmitter);
+        }
+
+        // Every emitter has its own particles and random stream, so they can
+        // all run at the same time
+        std::vector<IParticleEmitter*>& small = m_small;
+
+        m_pEngine->getJobSystem().parallel_for(0, small.size(), 1, [&small, elapsedTime] (std::size_t b, std::size_t e)
+        {
+            for(std::size_t i = b; i < e; i++)
+                small[i]->Update(elapsedTime);
+        });
+    }
+
+    void ParticleSystem::Draw()
+    {
+        PROFILE_SCOPE("ParticleSystem::Draw");
+
+        m_drawOrder.clear();
+        m_culledCount = 0;
+
+        const Camera& view = m_pEngine->getView();
+
+        for(std::size_t i = 0; i < m_emitters.size(); i++)
+        {
+            if(m_emitters[i]->getParticleCount() == 0)
+                continue;
+
+            if(!m_emitters[i]->isVisible(view))
+            {
+                ++m_culledCount;
+                continue;
+            }
+
+            m_drawOrder.push_back(m_emitters[i].get());
+        }
+
+        std::stable_sort(m_drawOrder.begin(), m_drawOrder.end(), batchLess);
+
+        m_batchCount = 0;
+
+        for(std::size_t first = 0; first < m_drawOrder.size(); )
+        {
+            std::size_t last = first;
+            std::size_t vertexCount = 0;
+
+            while(last < m_drawOrder.size() && sameBatch(m_drawOrder[first], m_drawOrder[last]))
+                vertexCount += m_drawOrder[last++]->getVertexCount();
+
+            // Vertex arrays are kept between frames, so they only allocate when they grow
+            if(m_batchCount >= m_batches.size())
+                m_batches.push_back(std::vector<sf::Vertex>());
+
+            std::vector<sf::Vertex>& batch = m_batches[m_batchCount++];
+            batch.resize(vertexCount);
+
+            std::size_t offset = 0;
+
+            for(std::size_t i = first; i < last; i++)
+            {
+                m_drawOrder[i]->writeVertices(&batch[offset], m_drawOrder[i]->getDrawAhead());
+                offset += m_drawOrder[i]->getVertexCount();
+            }
+
+            sf::RenderStates states(m_drawOrder[first]->getBlendMode());
+            states.texture = m_drawOrder[first]->getBatchTexture();
+
+            m_pEngine->DrawVertices(batch, sf::Triangles, states);
+
+            first = last;
+        }
+    }
+};
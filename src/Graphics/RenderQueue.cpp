@@ -0,0 +1,139 @@
+#include <Engine.h>
+
+#include <cstdint>
+
+namespace SuperEngine
+{
+    RenderQueue::RenderQueue()
+        : m_chunkIndex(0), m_chunkUsed(0), m_bufferCount(0), m_clearColor(sf::Color::Black)
+    {
+    }
+
+    RenderQueue::~RenderQueue()
+    {
+        clear();
+    }
+
+    void* RenderQueue::allocate(std::size_t bytes, std::size_t align)
+    {
+        while(m_chunkIndex < m_chunks.size())
+        {
+            Chunk& chunk = m_chunks[m_chunkIndex];
+
+            uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+            std::size_t offset = (base + m_chunkUsed + align - 1) / align * align - base;
+
+            if(offset + bytes <= chunk.size)
+            {
+                m_chunkUsed = offset + bytes;
+                return chunk.data.get() + offset;
+            }
+
+            // Doesn't fit, the rest of this chunk waits for the next frame
+            ++m_chunkIndex;
+            m_chunkUsed = 0;
+        }
+
+        // Out of chunks, only happens while the frames are still growing
+        Chunk chunk;
+        chunk.size = bytes + align > CHUNK_SIZE ? bytes + align : CHUNK_SIZE;
+        chunk.data.reset(new char[chunk.size]);
+        m_chunks.push_back(std::move(chunk));
+
+        return allocate(bytes, align);
+    }
+
+    RenderQueue::Command& RenderQueue::pushCommand(CommandType type, const sf::RenderStates& states)
+    {
+        m_commands.push_back(Command());
+
+        Command& cmd = m_commands.back();
+        cmd.type = type;
+        cmd.pDrawable = NULL;
+        cmd.destroy = NULL;
+        cmd.first = cmd.count = 0;
+        cmd.primitive = sf::Points;
+        cmd.states = states;
+        cmd.viewIndex = 0;
+
+        return cmd;
+    }
+
+    void RenderQueue::push(const sf::VertexArray& vertices, const sf::RenderStates& states)
+    {
+        Command& cmd = pushCommand(COMMAND_VERTICES, states);
+        cmd.first = m_vertices.size();
+        cmd.count = vertices.getVertexCount();
+        cmd.primitive = vertices.getPrimitiveType();
+
+        if(cmd.count > 0)
+            m_vertices.insert(m_vertices.end(), &vertices[0], &vertices[0] + cmd.count);
+    }
+
+    void RenderQueue::pushVertices(std::vector<sf::Vertex>& vertices, sf::PrimitiveType primitive, const sf::RenderStates& states)
+    {
+        if(m_bufferCount >= m_buffers.size())
+            m_buffers.push_back(std::vector<sf::Vertex>());
+
+        Command& cmd = pushCommand(COMMAND_BUFFER, states);
+        cmd.first = m_bufferCount;
+        cmd.count = vertices.size();
+        cmd.primitive = primitive;
+
+        m_buffers[m_bufferCount++].swap(vertices);
+    }
+
+    void RenderQueue::pushView(const sf::View& view)
+    {
+        m_views.push_back(view);
+
+        Command& cmd = pushCommand(COMMAND_VIEW, sf::RenderStates::Default);
+        cmd.viewIndex = m_views.size() - 1;
+    }
+
+    void RenderQueue::execute(sf::RenderTarget& target) const
+    {
+        target.clear(m_clearColor);
+
+        for(auto i = m_commands.begin(); i != m_commands.end(); ++i)
+        {
+            switch(i->type)
+            {
+            case COMMAND_DRAWABLE:
+                target.draw(*i->pDrawable, i->states);
+                break;
+
+            case COMMAND_VERTICES:
+                if(i->count > 0)
+                    target.draw(&m_vertices[i->first], i->count, i->primitive, i->states);
+                break;
+
+            case COMMAND_BUFFER:
+                if(i->count > 0)
+                    target.draw(&m_buffers[i->first][0], i->count, i->primitive, i->states);
+                break;
+
+            case COMMAND_VIEW:
+                target.setView(m_views[i->viewIndex]);
+                break;
+            }
+        }
+    }
+
+    void RenderQueue::clear()
+    {
+        for(auto i = m_commands.begin(); i != m_commands.end(); ++i)
+        {
+            if(i->type == COMMAND_DRAWABLE)
+                i->destroy(i->pDrawable);
+        }
+
+        // Keeps all the storage for the next frame
+        m_commands.clear();
+        m_views.clear();
+        m_vertices.clear();
+        m_bufferCount = 0;
+        m_chunkIndex = 0;
+        m_chunkUsed = 0;
+    }
+};
@@ -2,8 +2,8 @@
 
 namespace SuperEngine
 {
-    Sprite::Sprite()
-        : Drawable()
+    Sprite::Sprite(Engine& engine)
+        : Drawable(engine)
     {
         Init();
     }
@@ -33,13 +33,16 @@ namespace SuperEngine
 
         // Sync with real framerate
         this->m_useFrameTimer = true;
-        this->setFrameDelay(1000.0f / g_pEngine->getFPS());
+        this->setFrameDelay(1000.0f / getEngine()->getFPS());
 
         this->setCollidable(true);
         this->setCollisionMethod(COLLISION_RECT);
 
         this->setColor(sf::Color::Black);
 
+        m_layer = 0;
+        m_blendMode = sf::BlendAlpha;
+
         this->setVisible(true);
 
         return true;
@@ -77,7 +80,7 @@ namespace SuperEngine
         // using filenames as id's, for now anyway
 
         // Create a temp image with colormask
-        if(!g_pEngine->getTextureManager().exists(filename))
+        if(!getEngine()->getTextureManager().exists(filename))
         {
             sf::Image tempImage;
 
@@ -88,11 +91,11 @@ namespace SuperEngine
                 return false;
             }
 
-            g_pEngine->getTextureManager().load(filename, tempImage);
+            getEngine()->getTextureManager().load(filename, tempImage);
         }
 
         // Get the texture from storage
-        sf::Texture& texture = g_pEngine->getTextureManager().get(filename);
+        sf::Texture& texture = getEngine()->getTextureManager().get(filename);
 
         if(!this->genSprite(texture, animationCols, animationRows))
             return false;
@@ -119,14 +122,17 @@ namespace SuperEngine
         // Perform simple image transformations
         m_sprite.setScale(this->m_scale);
         m_sprite.setRotation(this->getRotation());
-        // Don't know if i'll keep this
-        m_sprite.setPosition(this->getPosition());
+        // Draw in between the last two updates so movement looks smooth
+        // even when the update rate is lower than the frame rate
+        m_sprite.setPosition(this->getInterpolatedPosition(getEngine()->getInterpolation()));
 
         m_sprite.setColor(this->getColor());
     }
 
     void Sprite::Draw()
     {
+        PROFILE_SCOPE("Sprite::Draw");
+
         // the base of all animation
         int fx = (this->m_curframe % this->m_animationCols) * m_frameSize.x;
         int fy = (this->m_curframe / this->m_animationCols) * m_frameSize.y;
@@ -136,9 +142,14 @@ namespace SuperEngine
         this->m_Transform();
 
         // Only draw if sprite is set as visible
-        if(getVisible())
-            g_pEngine->getDevice()->draw(m_sprite);
-        //g_pEngine->getDevice()->draw(m_sprite);
+        if(!getVisible())
+            return;
+
+        // Sorted and drawn with the other sprites at the end of the frame
+        if(getEngine()->isSpriteBatching())
+            getEngine()->getSpriteBatch().add(m_sprite, m_layer, m_blendMode);
+        else
+            getEngine()->Draw(m_sprite, sf::RenderStates(m_blendMode));
     }
 
     void Sprite::Move(float elapsedTime)
@@ -146,7 +157,7 @@ namespace SuperEngine
         // no movement timer -- move at CPU speed
 //        this->setPosition(this->getPosition().x + (this->getVelocity().x * elapsedTime),
 //                              this->getPosition().y + (this->getVelocity().y * elapsedTime));
-        this->setPosition(this->getPosition() + (this->getVelocity() * elapsedTime));
+        this->translate(this->getVelocity() * elapsedTime);
     }
 
     void Sprite::Animate()
@@ -0,0 +1,155 @@
+#include <Engine.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace SuperEngine
+{
+    namespace
+    {
+        struct EntryLess
+        {
+            template<typename T>
+            bool operator()(const T& a, const T& b) const
+            {
+                if(a.layer != b.layer)
+                    return a.layer < b.layer;
+
+                // Same layer, so both or neither are grouped
+                if(a.byTexture)
+                {
+                    if(a.texture != b.texture)
+                        return std::less<const sf::Texture*>()(a.texture, b.texture);
+
+                    if(a.blendMode != b.blendMode)
+                        return blendLess(a.blendMode, b.blendMode);
+                }
+
+                return a.index < b.index;
+            }
+        };
+    }
+
+    SpriteBatch::SpriteBatch(Engine& engine)
+        : m_pEngine(&engine), m_batchCount(0)
+    {
+    }
+
+    void SpriteBatch::add(const sf::Sprite& sprite, int layer, sf::BlendMode blendMode)
+    {
+        if(!sprite.getTexture())
+            return;
+
+        Entry entry;
+        entry.layer = layer;
+        entry.texture = sprite.getTexture();
+        entry.blendMode = blendMode;
+        entry.index = m_entries.size();
+        entry.byTexture = false;
+        m_entries.push_back(entry);
+
+        // Same corners and texture coordinates sf::Sprite uses
+        const sf::IntRect& rect = sprite.getTextureRect();
+        const sf::Transform& transform = sprite.getTransform();
+        const sf::Color& color = sprite.getColor();
+
+        float width = (float)std::abs(rect.width);
+        float height = (float)std::abs(rect.height);
+
+        float left = (float)rect.left;
+        float right = left + rect.width;
+        float top = (float)rect.top;
+        float bottom = top + rect.height;
+
+        m_quads.push_back(sf::Vertex(transform.transformPoint(0.f, 0.f), color, sf::Vector2f(left, top)));
+        m_quads.push_back(sf::Vertex(transform.transformPoint(0.f, height), color, sf::Vector2f(left, bottom)));
+        m_quads.push_back(sf::Vertex(transform.transformPoint(width, height), color, sf::Vector2f(right, bottom)));
+        m_quads.push_back(sf::Vertex(transform.transformPoint(width, 0.f), color, sf::Vector2f(right, top)));
+    }
+
+    void SpriteBatch::setSortByTexture(int layer, bool val)
+    {
+        std::vector<int>::iterator i = std::find(m_textureLayers.begin(), m_textureLayers.end(), layer);
+
+        if(val && i == m_textureLayers.end())
+            m_textureLayers.push_back(layer);
+        else if(!val && i != m_textureLayers.end())
+            m_textureLayers.erase(i);
+    }
+
+    bool SpriteBatch::isSortByTexture(int layer) const
+    {
+        return std::find(m_textureLayers.begin(), m_textureLayers.end(), layer) != m_textureLayers.end();
+    }
+
+    void SpriteBatch::Flush()
+    {
+        PROFILE_SCOPE("SpriteBatch::Flush");
+
+        if(m_entries.empty())
+            return;
+
+        m_batchCount = 0;
+
+        if(!m_textureLayers.empty())
+        {
+            for(std::size_t i = 0; i < m_entries.size(); i++)
+                m_entries[i].byTexture = isSortByTexture(m_entries[i].layer);
+        }
+
+        std::sort(m_entries.begin(), m_entries.end(), EntryLess());
+
+        for(std::size_t first = 0; first < m_entries.size(); )
+        {
+            const Entry& head = m_entries[first];
+
+            std::size_t last = first + 1;
+
+            // Runs can carry on in to the next layer, one call still draws
+            // them in order
+            while(last < m_entries.size() && m_entries[last].texture == head.texture &&
+                  m_entries[last].blendMode == head.blendMode)
+                ++last;
+
+            // Vertex arrays are kept between frames, so they only allocate when they grow
+            if(m_batchCount >= m_batches.size())
+            {
+                m_batches.push_back(std::vector<sf::Vertex>());
+                m_states.push_back(sf::RenderStates());
+            }
+
+            m_states[m_batchCount].blendMode = head.blendMode;
+            m_states[m_batchCount].texture = head.texture;
+
+            std::vector<sf::Vertex>& batch = m_batches[m_batchCount++];
+            batch.resize((last - first) * 4);
+
+            for(std::size_t i = first; i < last; i++)
+            {
+                const sf::Vertex* pQuad = &m_quads[m_entries[i].index * 4];
+                sf::Vertex* pOut = &batch[(i - first) * 4];
+
+                pOut[0] = pQuad[0];
+                pOut[1] = pQuad[1];
+                pOut[2] = pQuad[2];
+                pOut[3] = pQuad[3];
+            }
+
+            first = last;
+        }
+
+        // Emptied before drawing, the engine flushes anything left in the
+        // batch when it is handed something to draw
+        clear();
+
+        for(std::size_t i = 0; i < m_batchCount; i++)
+            m_pEngine->DrawVertices(m_batches[i], sf::Quads, m_states[i]);
+    }
+
+    void SpriteBatch::clear()
+    {
+        m_entries.clear();
+        m_quads.clear();
+    }
+};
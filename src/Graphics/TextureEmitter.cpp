@@ -2,21 +2,23 @@
 
 namespace SuperEngine
 {
-    TextureEmitter::TextureEmitter()
-        : IParticleEmitter()
+    TextureEmitter::TextureEmitter(Engine& engine)
+        : IParticleEmitter(engine)
     {
         // Set to normal scale, so no scale
         setScale(1.f);
+
+        m_renderer.setTexture(m_texture);
     }
 
     TextureEmitter::~TextureEmitter()
     {
-        m_particles.clear();
     }
 
     void TextureEmitter::setImage(sf::Texture& image)
     {
         m_texture = image;
+        m_renderer.setTexture(m_texture);
     }
 
     bool TextureEmitter::loadImage(const std::string& filename, const sf::Color& transcolor)
@@ -34,69 +36,43 @@ namespace SuperEngine
         }
 
         m_texture.loadFromImage(tempImage);
+        m_renderer.setTexture(m_texture);
 
         return true;
     }
 
-    void TextureEmitter::Add()
+    void TextureEmitter::Add(std::size_t count)
     {
-        Sprite p;
-
-        p.setPosition(getPosition());
-
-        // add some randomness to the spread, so it looks better
-        // this should be opt in though
-        double variation = ((rand() % getSpread()) - (getSpread() / 2)) / 100.0f;
-
-        double dir = getDirection() - 90.0f;
-        double vx = (cos(dir * RAD) + variation);
-        double vy = (sin(dir * RAD) + variation);
-
-        p.setVelocity(vx * getVelocity().x, vy * getVelocity().y);
-
-        // Check efficiency of this, is it really worth using the
-        // resource manager for this? I'll only use the image once for thousands of images
+        // Straight out of the emitter, coloured from the ranges
+        PointSpawn spawn;
+        RangeColor color;
 
-        p.setImage(m_texture);
-
-        int r = (rand() % (m_maxR - m_minR)) + m_minR;
-        int g = (rand() % (m_maxG - m_minG)) + m_minG;
-        int b = (rand() % (m_maxB - m_minB)) + m_minB;
-        int a = (rand() % (m_alphaMax - m_alphaMin)) + m_alphaMin;
-
-        p.setColor(r, g, b, a);
-
-        m_particles.push_back(p);
+        SpawnWith(spawn, color, count);
     }
 
     void TextureEmitter::Update(float elapsedTime)
     {
-        if((unsigned int)m_particles.size() < m_max)
-        {
-            if(!g_pEngine->getMaximizeProcessor())
-                sf::sleep(sf::milliseconds(1));
-
-            Add();
-        }
-
-        for(auto i = m_particles.begin(); i != m_particles.end(); ++i)
-        {
-            // Delegate work to sprite class
-            i->Move(elapsedTime);
+        PROFILE_SCOPE("TextureEmitter::Update");
 
-            if(getVecDistance(i->getPosition(), this->getPosition()) > getLength())
-            {
-                i->setPosition(this->getPosition());
-            }
-        }
+        UpdateParticles(elapsedTime);
     }
 
     void TextureEmitter::Draw()
     {
-        for(auto i = m_particles.begin(); i != m_particles.end(); ++i)
-        {
-            // Delegate drawing work to sprite
-            i->Draw();
-        }
+        PROFILE_SCOPE("TextureEmitter::Draw");
+
+        if(m_particles.empty() || !isVisible(getEngine()->getView()))
+            return;
+
+        // Same as the sprites did, draw where the particle is right now
+        float ahead = getDrawAhead();
+
+        m_vertices.resize(getVertexCount());
+        writeVertices(&m_vertices[0], ahead);
+
+        sf::RenderStates states(getBatchTexture());
+        states.blendMode = getBlendMode();
+
+        getEngine()->DrawVertices(m_vertices, sf::Triangles, states);
     }
 };
@@ -0,0 +1,142 @@
+#include <Engine.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+namespace SuperEngine
+{
+    namespace
+    {
+        std::size_t alignUp(std::size_t val, std::size_t align)
+        {
+            return (val + align - 1) / align * align;
+        }
+
+        // Marks headers, catches blocks that aren't ours or are freed twice
+        const std::size_t BLOCK_USED = 0x55534544;
+        const std::size_t BLOCK_FREE = 0x46524545;
+    }
+
+    ParticleArena::ParticleArena(std::size_t pageSize)
+        : m_pCurrent(NULL), m_remaining(0), m_pageSize(alignUp(pageSize, ARENA_ALIGN)), m_bytesInUse(0),
+          m_pFree(NULL)
+    {
+    }
+
+    ParticleArena::~ParticleArena()
+    {
+        release();
+    }
+
+    void* ParticleArena::allocate(std::size_t bytes)
+    {
+        bytes = alignUp(bytes, ARENA_ALIGN);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Smallest freed block that fits, as long as it isn't wasting more than half
+        BlockHeader** ppBest = NULL;
+
+        for(BlockHeader** pp = &m_pFree; *pp; pp = &(*pp)->pNextFree)
+        {
+            std::size_t size = (*pp)->size;
+
+            if(size >= bytes && size <= bytes * 2 && (!ppBest || size < (*ppBest)->size))
+                ppBest = pp;
+        }
+
+        BlockHeader* pHeader = NULL;
+
+        if(ppBest)
+        {
+            pHeader = *ppBest;
+            *ppBest = pHeader->pNextFree;
+
+            // Only the part that was asked for is handed out zeroed
+            std::memset(reinterpret_cast<char*>(pHeader) + ARENA_ALIGN, 0, bytes);
+        }
+        else
+        {
+            // The header takes a cache line in front of the block
+            std::size_t blockBytes = bytes + ARENA_ALIGN;
+
+            if(blockBytes > m_remaining)
+            {
+                // Big requests get a page of their own, the current page carries on
+                bool dedicated = blockBytes > m_pageSize / 2;
+                std::size_t pageBytes = dedicated ? blockBytes : m_pageSize;
+
+                void* pPage = std::calloc(pageBytes + ARENA_ALIGN, 1);
+
+                if(!pPage)
+                    return NULL;
+
+                m_pages.push_back(pPage);
+
+                char* pAligned = reinterpret_cast<char*>(alignUp(reinterpret_cast<uintptr_t>(pPage), ARENA_ALIGN));
+
+                if(dedicated)
+                    pHeader = reinterpret_cast<BlockHeader*>(pAligned);
+                else
+                {
+                    // Whatever was left of the old page is lost until release()
+                    m_pCurrent = pAligned;
+                    m_remaining = pageBytes;
+                }
+            }
+
+            if(blockBytes <= m_remaining)
+            {
+                pHeader = reinterpret_cast<BlockHeader*>(m_pCurrent);
+                m_pCurrent += blockBytes;
+                m_remaining -= blockBytes;
+            }
+
+            pHeader->size = bytes;
+        }
+
+        pHeader->magic = BLOCK_USED;
+        pHeader->pNextFree = NULL;
+        m_bytesInUse += pHeader->size;
+
+        return reinterpret_cast<char*>(pHeader) + ARENA_ALIGN;
+    }
+
+    void ParticleArena::free(void* p)
+    {
+        if(!p)
+            return;
+
+        BlockHeader* pHeader = reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - ARENA_ALIGN);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(pHeader->magic != BLOCK_USED)
+        {
+            #ifdef _DEBUG
+            Logger::getInstance() << WARN << "ParticleArena::free - block not in use from this arena" << std::endl;
+            #endif // _DEBUG
+            return;
+        }
+
+        pHeader->magic = BLOCK_FREE;
+        pHeader->pNextFree = m_pFree;
+        m_pFree = pHeader;
+        m_bytesInUse -= pHeader->size;
+    }
+
+    void ParticleArena::release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for(std::size_t i = 0; i < m_pages.size(); i++)
+            std::free(m_pages[i]);
+
+        m_pages.clear();
+        m_pFree = NULL;
+        m_pCurrent = NULL;
+        m_remaining = 0;
+        m_bytesInUse = 0;
+    }
+};
@@ -0,0 +1,375 @@
+#include <Engine.h>
+
+#include <sstream>
+
+namespace SuperEngine
+{
+    namespace
+    {
+        // Which queue the current thread owns, 0 for anything that isn't a worker
+        thread_local unsigned int t_queueIndex = 0;
+        thread_local const JobSystem* t_pOwner = NULL;
+
+        std::mutex s_sharedMutex;
+        std::weak_ptr<JobSystem> s_pShared;
+    }
+
+    JobSystem::JobSystem()
+        : m_running(false), m_queuedJobs(0)
+    {
+    }
+
+    JobSystem::~JobSystem()
+    {
+        Shutdown();
+    }
+
+    bool JobSystem::Init(unsigned int numWorkers)
+    {
+        if(m_running)
+            return true;
+
+        if(numWorkers == 0)
+        {
+            unsigned int cores = std::thread::hardware_concurrency();
+            numWorkers = cores > 1 ? cores - 1 : 1;
+        }
+
+        m_queues.clear();
+        for(unsigned int i = 0; i < numWorkers + 1; i++)
+            m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+
+        m_running = true;
+
+        for(unsigned int i = 0; i < numWorkers; i++)
+            m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i + 1));
+
+        #ifdef _DEBUG
+        Logger::getInstance() << INFO << "JobSystem started with " << numWorkers << " workers" << std::endl;
+        #endif // _DEBUG
+
+        return true;
+    }
+
+    std::shared_ptr<JobSystem> JobSystem::getShared(unsigned int numWorkers)
+    {
+        std::lock_guard<std::mutex> lock(s_sharedMutex);
+
+        std::shared_ptr<JobSystem> pJobs = s_pShared.lock();
+
+        if(!pJobs)
+        {
+            pJobs = std::make_shared<JobSystem>();
+            pJobs->Init(numWorkers);
+            s_pShared = pJobs;
+        }
+
+        return pJobs;
+    }
+
+    void JobSystem::Shutdown()
+    {
+        if(!m_running)
+            return;
+
+        // Finish off whatever is still queued, tasks may be waited on elsewhere
+        while(runPending())
+            ;
+
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_running = false;
+        }
+        m_sleepCond.notify_all();
+
+        for(auto i = m_workers.begin(); i != m_workers.end(); ++i)
+            i->join();
+
+        m_workers.clear();
+        m_queues.clear();
+        m_queuedJobs = 0;
+    }
+
+    unsigned int JobSystem::getLocalQueue() const
+    {
+        // Worker indices of another JobSystem mean nothing here
+        return t_pOwner == this ? t_queueIndex : 0;
+    }
+
+    void JobSystem::WorkQueue::pushBack(QueuedJob& job)
+    {
+        if(count == jobs.size())
+        {
+            // Full, unwrap in to one twice the size
+            std::vector<QueuedJob> bigger(jobs.size() * 2);
+
+            for(std::size_t i = 0; i < count; i++)
+                bigger[i] = std::move(jobs[(head + i) % jobs.size()]);
+
+            jobs.swap(bigger);
+            head = 0;
+        }
+
+        jobs[(head + count) % jobs.size()] = std::move(job);
+        ++count;
+    }
+
+    bool JobSystem::WorkQueue::popBack(QueuedJob& job)
+    {
+        if(count == 0)
+            return false;
+
+        --count;
+        job = std::move(jobs[(head + count) % jobs.size()]);
+
+        return true;
+    }
+
+    bool JobSystem::WorkQueue::popFront(QueuedJob& job)
+    {
+        if(count == 0)
+            return false;
+
+        job = std::move(jobs[head]);
+        head = (head + 1) % jobs.size();
+        --count;
+
+        return true;
+    }
+
+    void JobSystem::push(QueuedJob& job)
+    {
+        job.pProfiler = &Profiler::getCurrent();
+
+        // Not started, just run it in place
+        if(!m_running)
+        {
+            execute(job);
+            return;
+        }
+
+        // Count first so a thief can never take the counter below zero
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            ++m_queuedJobs;
+        }
+
+        WorkQueue& queue = *m_queues[getLocalQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.pushBack(job);
+        }
+
+        m_sleepCond.notify_one();
+    }
+
+    void JobSystem::push(const Job& job)
+    {
+        QueuedJob queued;
+        queued.job = job;
+
+        push(queued);
+    }
+
+    bool JobSystem::pop(unsigned int queueIndex, QueuedJob& job)
+    {
+        WorkQueue& queue = *m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        // Newest first, it's the most likely to still be in cache
+        if(!queue.popBack(job))
+            return false;
+
+        --m_queuedJobs;
+
+        return true;
+    }
+
+    bool JobSystem::steal(unsigned int thiefIndex, QueuedJob& job)
+    {
+        const unsigned int count = m_queues.size();
+
+        for(unsigned int n = 1; n < count; n++)
+        {
+            WorkQueue& queue = *m_queues[(thiefIndex + n) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            // Oldest first, these tend to be the biggest pieces of work
+            if(!queue.popFront(job))
+                continue;
+
+            --m_queuedJobs;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool JobSystem::runPending()
+    {
+        if(m_queues.empty())
+            return false;
+
+        unsigned int index = getLocalQueue();
+        QueuedJob job;
+
+        if(!pop(index, job) && !steal(index, job))
+            return false;
+
+        execute(job);
+
+        return true;
+    }
+
+    void JobSystem::execute(QueuedJob& job)
+    {
+        ProfilerBinding profilerBinding(*job.pProfiler);
+
+        if(job.range)
+        {
+            job.range(job.pFunc, job.begin, job.end);
+
+            // The caller is waiting on this, job may be gone straight after
+            --*job.pRemaining;
+        }
+        else
+            job.job();
+    }
+
+    void JobSystem::WorkerLoop(unsigned int queueIndex)
+    {
+        t_queueIndex = queueIndex;
+        t_pOwner = this;
+
+        std::ostringstream name;
+        name << "Worker " << queueIndex;
+        Profiler::setThreadName(name.str());
+
+        while(true)
+        {
+            QueuedJob job;
+
+            if(pop(queueIndex, job) || steal(queueIndex, job))
+            {
+                execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCond.wait(lock, [this] { return !m_running || m_queuedJobs > 0; });
+
+            if(!m_running)
+                break;
+        }
+
+        t_pOwner = NULL;
+    }
+
+    void JobSystem::run(const Job& job)
+    {
+        push(job);
+    }
+
+    JobSystem::TaskHandle JobSystem::createTask(const Job& job)
+    {
+        return std::make_shared<Task>(job);
+    }
+
+    void JobSystem::addDependency(const TaskHandle& task, const TaskHandle& dependsOn)
+    {
+        std::lock_guard<std::mutex> lock(dependsOn->m_mutex);
+
+        // Already finished, nothing to wait for
+        if(dependsOn->isDone())
+            return;
+
+        ++task->m_pending;
+        dependsOn->m_continuations.push_back(task);
+    }
+
+    void JobSystem::submit(const TaskHandle& task)
+    {
+        // Release the submit reference, schedules right away if there are
+        // no dependencies left
+        if(--task->m_pending == 0)
+            schedule(task);
+    }
+
+    void JobSystem::schedule(const TaskHandle& task)
+    {
+        push([this, task] ()
+        {
+            task->m_job();
+            finish(task);
+        });
+    }
+
+    void JobSystem::finish(const TaskHandle& task)
+    {
+        std::vector<TaskHandle> continuations;
+
+        {
+            std::lock_guard<std::mutex> lock(task->m_mutex);
+            task->m_done.store(true, std::memory_order_release);
+            continuations.swap(task->m_continuations);
+        }
+
+        for(auto i = continuations.begin(); i != continuations.end(); ++i)
+        {
+            if(--(*i)->m_pending == 0)
+                schedule(*i);
+        }
+    }
+
+    void JobSystem::wait(const TaskHandle& task)
+    {
+        while(!task->isDone())
+        {
+            // Help out instead of blocking
+            if(!runPending())
+                std::this_thread::yield();
+        }
+    }
+
+    void JobSystem::ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize,
+                                RangeFunc range, const void* pFunc)
+    {
+        if(begin >= end)
+            return;
+
+        if(grainSize == 0)
+            grainSize = 1;
+
+        // Not worth splitting, or there is nobody to split it with
+        if(end - begin <= grainSize || !m_running || m_workers.empty())
+        {
+            range(pFunc, begin, end);
+            return;
+        }
+
+        std::atomic<std::size_t> remaining((end - begin + grainSize - 1) / grainSize);
+
+        // Keep the first chunk for this thread, queue the rest
+        for(std::size_t chunk = begin + grainSize; chunk < end; chunk += grainSize)
+        {
+            QueuedJob job;
+            job.range = range;
+            job.pFunc = pFunc;
+            job.begin = chunk;
+            job.end = std::min(chunk + grainSize, end);
+            job.pRemaining = &remaining;
+
+            push(job);
+        }
+
+        range(pFunc, begin, std::min(begin + grainSize, end));
+        --remaining;
+
+        while(remaining > 0)
+        {
+            if(!runPending())
+                std::this_thread::yield();
+        }
+    }
+};
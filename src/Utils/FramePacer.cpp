@@ -0,0 +1,73 @@
+#include <Utils/FramePacer.h>
+
+#include <thread>
+
+namespace SuperEngine
+{
+    FramePacer::FramePacer()
+        : m_period(Clock::duration::zero()), m_spinThreshold(std::chrono::microseconds(500)),
+        m_started(false), m_missedDeadlines(0), m_lastLateness(0.f)
+    {
+    }
+
+    void FramePacer::setTargetFPS(unsigned int fps)
+    {
+        if(fps == 0)
+            m_period = Clock::duration::zero();
+        else
+            m_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+
+        reset();
+    }
+
+    unsigned int FramePacer::getTargetFPS() const
+    {
+        if(m_period == Clock::duration::zero())
+            return 0;
+
+        return (unsigned int)(1.0 / std::chrono::duration<double>(m_period).count() + 0.5);
+    }
+
+    void FramePacer::reset()
+    {
+        m_started = false;
+    }
+
+    bool FramePacer::wait()
+    {
+        if(m_period == Clock::duration::zero())
+            return true;
+
+        Clock::time_point now = Clock::now();
+
+        if(!m_started)
+        {
+            m_started = true;
+            m_nextDeadline = now + m_period;
+            return true;
+        }
+
+        if(now > m_nextDeadline)
+        {
+            // Too late already, don't try to make up for it with shorter frames,
+            // just start counting again from here
+            ++m_missedDeadlines;
+            m_lastLateness = std::chrono::duration<float>(now - m_nextDeadline).count();
+            m_nextDeadline = now + m_period;
+
+            return false;
+        }
+
+        // Sleep for the bulk of it, the scheduler may oversleep so stop early
+        if(m_nextDeadline - now > m_spinThreshold)
+            std::this_thread::sleep_until(m_nextDeadline - m_spinThreshold);
+
+        while(Clock::now() < m_nextDeadline)
+            std::this_thread::yield();
+
+        // Stepping from the deadline rather than from now keeps the rate exact
+        m_nextDeadline += m_period;
+
+        return true;
+    }
+};
@@ -0,0 +1,98 @@
+#include <Utils/FrameStats.h>
+
+#include <algorithm>
+
+namespace SuperEngine
+{
+    FrameStats::FrameStats(std::size_t windowSize)
+        : m_samples(windowSize > 0 ? windowSize : 1), m_sorted(m_samples.size()), m_sequence(0)
+    {
+        reset();
+    }
+
+    void FrameStats::reset()
+    {
+        m_next = 0;
+        m_count = 0;
+        m_frames = 0;
+        m_ticks = 0;
+        m_droppedTicks = 0;
+        m_pendingTicks = 0;
+
+        publish();
+    }
+
+    void FrameStats::addFrame(float seconds)
+    {
+        Sample& sample = m_samples[m_next];
+        sample.seconds = seconds;
+        sample.ticks = m_pendingTicks;
+
+        m_next = (m_next + 1) % m_samples.size();
+        m_count = std::min(m_count + 1, m_samples.size());
+
+        ++m_frames;
+        m_ticks += m_pendingTicks;
+        m_pendingTicks = 0;
+
+        publish();
+    }
+
+    void FrameStats::publish()
+    {
+        FrameStatsSnapshot snapshot = FrameStatsSnapshot();
+        snapshot.frames = m_frames;
+        snapshot.ticks = m_ticks;
+        snapshot.droppedTicks = m_droppedTicks;
+
+        if(m_count > 0)
+        {
+            float total = 0.f;
+            unsigned long ticks = 0;
+
+            for(std::size_t i = 0; i < m_count; i++)
+            {
+                m_sorted[i] = m_samples[i].seconds * 1000.f;
+                total += m_samples[i].seconds;
+                ticks += m_samples[i].ticks;
+            }
+
+            std::sort(m_sorted.begin(), m_sorted.begin() + m_count);
+
+            snapshot.meanMs = total * 1000.f / m_count;
+            snapshot.p50Ms = m_sorted[(m_count - 1) * 50 / 100];
+            snapshot.p95Ms = m_sorted[(m_count - 1) * 95 / 100];
+            snapshot.p99Ms = m_sorted[(m_count - 1) * 99 / 100];
+            snapshot.maxMs = m_sorted[m_count - 1];
+
+            if(total > 0.f)
+            {
+                snapshot.frameRate = m_count / total;
+                snapshot.tickRate = ticks / total;
+            }
+        }
+
+        // Seqlock write, readers see an odd number and try again
+        m_sequence.fetch_add(1, std::memory_order_acq_rel);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_snapshot = snapshot;
+        m_sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    FrameStatsSnapshot FrameStats::getSnapshot() const
+    {
+        FrameStatsSnapshot snapshot;
+        unsigned int before, after;
+
+        do
+        {
+            before = m_sequence.load(std::memory_order_acquire);
+            snapshot = m_snapshot;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        }
+        while((before & 1) || before != after);
+
+        return snapshot;
+    }
+};
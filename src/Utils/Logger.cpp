@@ -1,4 +1,5 @@
 #include <Utils/Logger.h>
+#include <Utils/Profiler.h>
 
 // For time logging
 #include <ctime>
@@ -38,8 +39,40 @@ namespace SuperEngine
         }
     }
 
+    std::ostringstream& Logger::line()
+    {
+        static thread_local std::ostringstream buffer;
+
+        return buffer;
+    }
+
+    void Logger::writeLine()
+    {
+        std::ostringstream& buffer = line();
+
+        {
+            // Covers waiting on the lock and the flush, so slow logging shows up in a trace
+            PROFILE_SCOPE("Logger::writeLine");
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_writeTime = true;
+            writeTime();
+
+            m_out << buffer.str();
+            m_out.flush();
+        }
+
+        buffer.str(std::string());
+        buffer.clear();
+    }
+
     void Logger::flush()
     {
+        PROFILE_SCOPE("Logger::flush");
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
         m_writeTime = true;
         m_out.flush();
         m_out.close();
@@ -47,9 +80,15 @@ namespace SuperEngine
 
     Logger& operator<<(Logger& os, std::ostream& (*fun)(std::ostream&))
     {
-        os.setWriteTime(true);
+        os.line() << fun;
+
+        std::ostream& (*flushFun)(std::ostream&) = std::flush;
+        const std::string text = os.line().str();
+
+        // endl leaves a newline at the end, either way the line is done
+        if(fun == flushFun || (!text.empty() && text[text.size() - 1] == '\n'))
+            os.writeLine();
 
-        os.stream() << fun;
         return os;
     }
 };
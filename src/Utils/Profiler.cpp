@@ -0,0 +1,319 @@
+#include <Utils/Profiler.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace SuperEngine
+{
+    namespace
+    {
+        // The calling thread's buffer in each profiler it has used, by id
+        thread_local std::vector<std::pair<unsigned int, void*> > t_profilerBuffers;
+        thread_local Profiler* t_pCurrentProfiler = NULL;
+        thread_local std::string t_threadName;
+
+        std::atomic<unsigned int> s_nextProfilerId(0);
+    }
+
+    Profiler::Profiler()
+        : m_id(++s_nextProfilerId), m_enabled(true), m_frameCount(0), m_frameStart(now()),
+        m_capturing(false), m_captureStart(0), m_captureLength(0)
+    {
+    }
+
+    Profiler::~Profiler()
+    {
+        if(m_writer.joinable())
+            m_writer.join();
+    }
+
+    Profiler& Profiler::getCurrent()
+    {
+        if(t_pCurrentProfiler)
+            return *t_pCurrentProfiler;
+
+        static Profiler instance;
+
+        return instance;
+    }
+
+    Profiler* Profiler::setCurrent(Profiler* pProfiler)
+    {
+        Profiler* pPrevious = t_pCurrentProfiler;
+        t_pCurrentProfiler = pProfiler;
+
+        return pPrevious;
+    }
+
+    long long Profiler::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Profiler::ThreadBuffer& Profiler::getThreadBuffer()
+    {
+        // Only a couple of entries, one per engine this thread worked for
+        for(auto i = t_profilerBuffers.begin(); i != t_profilerBuffers.end(); ++i)
+        {
+            if(i->first == m_id)
+                return *static_cast<ThreadBuffer*>(i->second);
+        }
+
+        // First zone on this thread, buffers are never freed so a thread
+        // can exit without the profiler losing its last records
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->index = m_buffers.size();
+        buffer->name = t_threadName;
+        t_profilerBuffers.push_back(std::make_pair(m_id, (void*)buffer.get()));
+        m_buffers.push_back(std::move(buffer));
+
+        return *m_buffers.back();
+    }
+
+    void Profiler::setThreadName(const std::string& name)
+    {
+        t_threadName = name;
+
+        // Buffers made from now on take the name, fix up the current one
+        ThreadBuffer& buffer = getCurrent().getThreadBuffer();
+
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    void Profiler::beginZone(const char* name)
+    {
+        ThreadBuffer& buffer = getThreadBuffer();
+
+        buffer.names.push_back(name);
+        buffer.starts.push_back(now());
+    }
+
+    void Profiler::endZone()
+    {
+        ThreadBuffer& buffer = getThreadBuffer();
+
+        if(buffer.names.empty())
+            return;
+
+        Record record;
+        record.end = now();
+        record.start = buffer.starts.back();
+        record.name = buffer.names.back();
+        record.depth = buffer.names.size() - 1;
+        record.parent = record.depth > 0 ? buffer.names[record.depth - 1] : "";
+
+        buffer.names.pop_back();
+        buffer.starts.pop_back();
+
+        if(!m_enabled)
+            return;
+
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.records.push_back(record);
+    }
+
+    void Profiler::endFrame()
+    {
+        std::vector<ZoneStats> frame;
+        std::vector<Record> records;
+
+        std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+
+        for(auto i = m_buffers.begin(); i != m_buffers.end(); ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock((*i)->mutex);
+                records.swap((*i)->records);
+            }
+
+            if(m_capturing)
+            {
+                for(auto r = records.begin(); r != records.end(); ++r)
+                {
+                    TraceEvent event = { r->name, (*i)->index, r->start, r->end };
+                    m_captureEvents.push_back(event);
+                }
+            }
+
+            // Records arrive as zones close, so children come before their
+            // parents. Merge them, then walk backwards to get the tree order.
+            std::vector<ZoneStats> merged;
+
+            for(auto r = records.rbegin(); r != records.rend(); ++r)
+            {
+                auto found = merged.begin();
+                for(; found != merged.end(); ++found)
+                {
+                    if(found->depth == r->depth && found->name == r->name && found->parent == r->parent)
+                        break;
+                }
+
+                if(found == merged.end())
+                {
+                    ZoneStats stats;
+                    stats.name = r->name;
+                    stats.parent = r->parent;
+                    stats.depth = r->depth;
+                    stats.threadIndex = (*i)->index;
+                    stats.calls = 0;
+                    stats.totalMs = 0.0;
+                    merged.push_back(stats);
+                    found = merged.end() - 1;
+                }
+
+                found->calls++;
+                found->totalMs += (r->end - r->start) / 1000000.0;
+            }
+
+            frame.insert(frame.end(), merged.begin(), merged.end());
+            records.clear();
+        }
+
+        long long frameEnd = now();
+
+        if(m_capturing)
+        {
+            m_captureFrames.push_back(m_frameStart);
+
+            if(frameEnd - m_captureStart >= m_captureLength)
+            {
+                m_captureFrames.push_back(frameEnd);
+
+                std::shared_ptr<Capture> pCapture(new Capture());
+                takeCapture(*pCapture);
+
+                // Writing can take a while, don't hold up the frame or
+                // anyone opening a zone for it
+                if(m_writer.joinable())
+                    m_writer.join();
+
+                m_writer = std::thread([pCapture] { writeCapture(*pCapture); });
+            }
+        }
+
+        m_frameStart = frameEnd;
+
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_lastFrame.swap(frame);
+        ++m_frameCount;
+    }
+
+    void Profiler::beginCapture(const std::string& filename, float seconds)
+    {
+        // The last capture may still be going out to the same file
+        if(m_writer.joinable())
+            m_writer.join();
+
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+        m_captureFile = filename;
+        m_captureStart = now();
+        m_captureLength = (long long)(seconds * 1000000000.0);
+        m_captureEvents.clear();
+        m_captureFrames.clear();
+        m_capturing = true;
+    }
+
+    bool Profiler::endCapture()
+    {
+        Capture capture;
+
+        {
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+            if(!m_capturing)
+                return false;
+
+            m_captureFrames.push_back(now());
+            takeCapture(capture);
+        }
+
+        return writeCapture(capture);
+    }
+
+    void Profiler::takeCapture(Capture& capture)
+    {
+        m_capturing = false;
+
+        capture.filename = m_captureFile;
+        capture.start = m_captureStart;
+        capture.events.swap(m_captureEvents);
+        capture.frames.swap(m_captureFrames);
+
+        for(auto i = m_buffers.begin(); i != m_buffers.end(); ++i)
+        {
+            std::lock_guard<std::mutex> lock((*i)->mutex);
+            capture.threadNames.push_back((*i)->name.empty() ? "Thread" : (*i)->name);
+        }
+    }
+
+    bool Profiler::writeCapture(const Capture& capture)
+    {
+        std::ofstream out(capture.filename.c_str(), std::ios::out);
+
+        if(!out.is_open())
+            return false;
+
+        // Chrome wants microseconds relative to anything, start of the capture will do
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+
+        bool first = true;
+
+        for(std::size_t i = 0; i < capture.threadNames.size(); i++)
+        {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << i << ",\"args\":{\"name\":\"" << capture.threadNames[i] << "\"}}";
+            first = false;
+        }
+
+        // Frames get their own row so hitches are easy to spot
+        const unsigned int frameRow = capture.threadNames.size();
+
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << frameRow << ",\"args\":{\"name\":\"Frames\"}}";
+
+        for(std::size_t f = 0; f + 1 < capture.frames.size(); f++)
+        {
+            out << ",\n{\"name\":\"Frame " << f << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":" << frameRow << ",\"ts\":"
+                << (capture.frames[f] - capture.start) / 1000.0 << ",\"dur\":"
+                << (capture.frames[f + 1] - capture.frames[f]) / 1000.0 << "}";
+        }
+
+        for(auto e = capture.events.begin(); e != capture.events.end(); ++e)
+        {
+            out << ",\n{\"name\":\"" << e->name << "\",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << e->threadIndex << ",\"ts\":" << (e->start - capture.start) / 1000.0
+                << ",\"dur\":" << (e->end - e->start) / 1000.0 << "}";
+        }
+
+        out << std::endl << "]}" << std::endl;
+
+        return out.good();
+    }
+
+    std::vector<ZoneStats> Profiler::getLastFrame() const
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+
+        return m_lastFrame;
+    }
+
+    void Profiler::report(std::ostream& out) const
+    {
+        std::vector<ZoneStats> frame = getLastFrame();
+
+        for(auto i = frame.begin(); i != frame.end(); ++i)
+        {
+            out << "[T" << i->threadIndex << "] " << std::string(i->depth * 2, ' ') << i->name
+                << " " << std::fixed << std::setprecision(3) << i->totalMs << "ms"
+                << " x" << i->calls << std::endl;
+        }
+    }
+};
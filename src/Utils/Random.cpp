@@ -0,0 +1,147 @@
+#include <Engine.h>
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SE_RANDOM_SSE2
+#endif
+
+namespace SuperEngine
+{
+    std::atomic<std::uint64_t> Random::s_threadSeed(0);
+
+    namespace
+    {
+        std::uint64_t splitMix64(std::uint64_t& x)
+        {
+            std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        inline std::uint32_t rotl(std::uint32_t x, int k)
+        {
+            return (x << k) | (x >> (32 - k));
+        }
+
+        // One step of xoshiro128+ on lane i of the state
+        inline std::uint32_t step(std::uint32_t (&s)[4][4], int i)
+        {
+            const std::uint32_t result = s[0][i] + s[3][i];
+            const std::uint32_t t = s[1][i] << 9;
+
+            s[2][i] ^= s[0][i];
+            s[3][i] ^= s[1][i];
+            s[1][i] ^= s[2][i];
+            s[0][i] ^= s[3][i];
+            s[2][i] ^= t;
+            s[3][i] = rotl(s[3][i], 11);
+
+            return result;
+        }
+
+        std::atomic<std::uint64_t> g_threadCount(0);
+    }
+
+    Random::Random(std::uint64_t seed)
+    {
+        this->seed(seed);
+    }
+
+    void Random::seed(std::uint64_t seed)
+    {
+        std::uint64_t x = seed;
+
+        for(int word = 0; word < 4; word++)
+            for(int lane = 0; lane < 4; lane++)
+                m_state[word][lane] = (std::uint32_t)(splitMix64(x) >> 32);
+
+        // All zero is the one state xoshiro can't get out of
+        for(int lane = 0; lane < 4; lane++)
+            if(!(m_state[0][lane] | m_state[1][lane] | m_state[2][lane] | m_state[3][lane]))
+                m_state[0][lane] = 1;
+    }
+
+    std::uint64_t Random::mix(std::uint64_t seed, std::uint64_t stream)
+    {
+        std::uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+        return splitMix64(x);
+    }
+
+    std::uint32_t Random::next()
+    {
+        return step(m_state, 0);
+    }
+
+    int Random::rangeInt(int minVal, int maxVal)
+    {
+        if(maxVal <= minVal)
+            return minVal;
+
+        // Multiply and shift instead of %, no division and less bias
+        std::uint64_t span = (std::uint64_t)((std::int64_t)maxVal - minVal);
+        return minVal + (int)((next() * span) >> 32);
+    }
+
+    void Random::fillUniform(float* pOut, std::size_t count, float minVal, float maxVal)
+    {
+        const float scale = (maxVal - minVal) * (1.f / 16777216.f);
+        std::size_t i = 0;
+
+        #ifdef SE_RANDOM_SSE2
+        __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[0]));
+        __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[1]));
+        __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[2]));
+        __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[3]));
+
+        const __m128 scale4 = _mm_set1_ps(scale);
+        const __m128 min4 = _mm_set1_ps(minVal);
+
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128i result = _mm_add_epi32(s0, s3);
+            __m128i t = _mm_slli_epi32(s1, 9);
+
+            s2 = _mm_xor_si128(s2, s0);
+            s3 = _mm_xor_si128(s3, s1);
+            s1 = _mm_xor_si128(s1, s2);
+            s0 = _mm_xor_si128(s0, s3);
+            s2 = _mm_xor_si128(s2, t);
+            s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+            // Top 24 bits fit a float exactly and are positive as an int
+            __m128 f = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+            _mm_storeu_ps(pOut + i, _mm_add_ps(min4, _mm_mul_ps(f, scale4)));
+        }
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[0]), s0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[1]), s1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[2]), s2);
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[3]), s3);
+        #else
+        for(; i + 4 <= count; i += 4)
+            for(int lane = 0; lane < 4; lane++)
+                pOut[i + lane] = minVal + (step(m_state, lane) >> 8) * scale;
+        #endif // SE_RANDOM_SSE2
+
+        // Whatever is left over takes a whole step so both paths stay in sync
+        if(i < count)
+        {
+            float rest[4];
+
+            for(int lane = 0; lane < 4; lane++)
+                rest[lane] = minVal + (step(m_state, lane) >> 8) * scale;
+
+            std::memcpy(pOut + i, rest, (count - i) * sizeof(float));
+        }
+    }
+
+    Random& Random::getThreadStream()
+    {
+        thread_local Random stream(mix(s_threadSeed, ++g_threadCount));
+        return stream;
+    }
+};
@@ -0,0 +1,282 @@
+#include <Engine.h>
+
+#include <cstring>
+
+namespace SuperEngine
+{
+    namespace
+    {
+        const char REPLAY_MAGIC[4] = { 'S', 'E', 'R', 'P' };
+        const sf::Uint16 REPLAY_VERSION = 1;
+    }
+
+    Replay::Replay()
+        : m_mode(REPLAY_NONE), m_seed(0), m_frameLoaded(false),
+        m_frameTime(0.f), m_nextEvent(0), m_frameCount(0)
+    {
+    }
+
+    Replay::~Replay()
+    {
+        stop();
+    }
+
+    bool Replay::record(const std::string& filename, unsigned int seed)
+    {
+        stop();
+
+        m_out.open(filename.c_str(), std::ios::out | std::ios::binary);
+
+        if(!m_out.is_open())
+        {
+            Logger::getInstance() << WARN << "Replay::record - Could not open " << filename << std::endl;
+            return false;
+        }
+
+        m_seed = seed;
+
+        m_out.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+        write<sf::Uint16>(REPLAY_VERSION);
+        write<sf::Uint32>(seed);
+
+        m_mode = REPLAY_RECORDING;
+        m_frameCount = 0;
+
+        return true;
+    }
+
+    bool Replay::play(const std::string& filename)
+    {
+        stop();
+
+        m_in.open(filename.c_str(), std::ios::in | std::ios::binary);
+
+        if(!m_in.is_open())
+        {
+            Logger::getInstance() << WARN << "Replay::play - Could not open " << filename << std::endl;
+            return false;
+        }
+
+        char magic[4];
+        sf::Uint16 version = 0;
+        sf::Uint32 seed = 0;
+
+        if(!m_in.read(magic, sizeof(magic)) || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0 ||
+           !read(version) || version != REPLAY_VERSION || !read(seed))
+        {
+            Logger::getInstance() << WARN << "Replay::play - " << filename << " is not a replay log" << std::endl;
+            m_in.close();
+            return false;
+        }
+
+        m_seed = seed;
+        m_mode = REPLAY_PLAYING;
+        m_frameLoaded = false;
+        m_frameCount = 0;
+
+        return true;
+    }
+
+    void Replay::stop()
+    {
+        if(m_out.is_open())
+            m_out.close();
+
+        if(m_in.is_open())
+            m_in.close();
+
+        m_pendingEvents.clear();
+        m_frameEvents.clear();
+        m_frameLoaded = false;
+        m_mode = REPLAY_NONE;
+    }
+
+    void Replay::addEvent(const sf::Event& event)
+    {
+        if(isRecording())
+            m_pendingEvents.push_back(event);
+    }
+
+    void Replay::writeFrame(float frameTime)
+    {
+        if(!isRecording())
+            return;
+
+        write<float>(frameTime);
+        write<sf::Uint16>(m_pendingEvents.size());
+
+        for(auto i = m_pendingEvents.begin(); i != m_pendingEvents.end(); ++i)
+            writeEvent(*i);
+
+        m_pendingEvents.clear();
+        ++m_frameCount;
+    }
+
+    void Replay::writeEvent(const sf::Event& event)
+    {
+        write<sf::Uint8>(event.type);
+
+        // Only the parts of the union that the event actually uses
+        switch(event.type)
+        {
+        case sf::Event::Resized:
+            write<sf::Uint16>(event.size.width);
+            write<sf::Uint16>(event.size.height);
+            break;
+
+        case sf::Event::TextEntered:
+            write<sf::Uint32>(event.text.unicode);
+            break;
+
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+            write<sf::Int8>(event.key.code);
+            write<sf::Uint8>((event.key.alt ? 1 : 0) | (event.key.control ? 2 : 0) |
+                             (event.key.shift ? 4 : 0) | (event.key.system ? 8 : 0));
+            break;
+
+        case sf::Event::MouseWheelMoved:
+            write<sf::Int16>(event.mouseWheel.delta);
+            write<sf::Int16>(event.mouseWheel.x);
+            write<sf::Int16>(event.mouseWheel.y);
+            break;
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            write<sf::Uint8>(event.mouseButton.button);
+            write<sf::Int16>(event.mouseButton.x);
+            write<sf::Int16>(event.mouseButton.y);
+            break;
+
+        case sf::Event::MouseMoved:
+            write<sf::Int16>(event.mouseMove.x);
+            write<sf::Int16>(event.mouseMove.y);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    bool Replay::readEvent(sf::Event& event)
+    {
+        sf::Uint8 type;
+        if(!read(type))
+            return false;
+
+        event.type = (sf::Event::EventType)type;
+
+        switch(event.type)
+        {
+        case sf::Event::Resized:
+        {
+            sf::Uint16 width, height;
+            if(!read(width) || !read(height)) return false;
+            event.size.width = width;
+            event.size.height = height;
+            break;
+        }
+
+        case sf::Event::TextEntered:
+        {
+            sf::Uint32 unicode;
+            if(!read(unicode)) return false;
+            event.text.unicode = unicode;
+            break;
+        }
+
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+        {
+            sf::Int8 code;
+            sf::Uint8 mods;
+            if(!read(code) || !read(mods)) return false;
+            event.key.code = (sf::Keyboard::Key)code;
+            event.key.alt = (mods & 1) != 0;
+            event.key.control = (mods & 2) != 0;
+            event.key.shift = (mods & 4) != 0;
+            event.key.system = (mods & 8) != 0;
+            break;
+        }
+
+        case sf::Event::MouseWheelMoved:
+        {
+            sf::Int16 delta, x, y;
+            if(!read(delta) || !read(x) || !read(y)) return false;
+            event.mouseWheel.delta = delta;
+            event.mouseWheel.x = x;
+            event.mouseWheel.y = y;
+            break;
+        }
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+        {
+            sf::Uint8 button;
+            sf::Int16 x, y;
+            if(!read(button) || !read(x) || !read(y)) return false;
+            event.mouseButton.button = (sf::Mouse::Button)button;
+            event.mouseButton.x = x;
+            event.mouseButton.y = y;
+            break;
+        }
+
+        case sf::Event::MouseMoved:
+        {
+            sf::Int16 x, y;
+            if(!read(x) || !read(y)) return false;
+            event.mouseMove.x = x;
+            event.mouseMove.y = y;
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        return true;
+    }
+
+    bool Replay::loadFrame()
+    {
+        if(!isPlaying())
+            return false;
+
+        if(m_frameLoaded)
+            return true;
+
+        sf::Uint16 count;
+
+        if(!read(m_frameTime) || !read(count))
+            return false;
+
+        m_frameEvents.resize(count);
+
+        for(sf::Uint16 i = 0; i < count; i++)
+        {
+            if(!readEvent(m_frameEvents[i]))
+                return false;
+        }
+
+        m_nextEvent = 0;
+        m_frameLoaded = true;
+
+        return true;
+    }
+
+    bool Replay::pollEvent(sf::Event& event)
+    {
+        if(!loadFrame() || m_nextEvent >= m_frameEvents.size())
+            return false;
+
+        event = m_frameEvents[m_nextEvent++];
+
+        return true;
+    }
+
+    void Replay::endFrame()
+    {
+        m_frameLoaded = false;
+        ++m_frameCount;
+    }
+};
@@ -40,7 +40,8 @@ int main()
 
     while(!gameover)
     {
-        while(g_pEngine->getDevice()->pollEvent(event))
+        // Events come from the window, or from the log when replaying
+        while(g_pEngine->pollEvent(event))
         {
             switch(event.type)
             {
@@ -50,7 +51,7 @@ int main()
                 break;
             }
         }
-        // TODO: Drawing and rendering both run in threads
+        // Rendering runs on its own thread if setThreadedRendering(true) was used
         g_pEngine->Update();
     }
 